@@ -0,0 +1,10 @@
+// src/clock_geom.cpp
+#include "clock_geom.h"
+
+int lodSegments(float rpx){
+    if(rpx <= LOD_MAX_ERROR_PX) return LOD_MIN_SEG;
+    double n = CX_PI / std::acos(1.0 - LOD_MAX_ERROR_PX/rpx);
+    int seg = LOD_MIN_SEG;
+    while(seg < n && seg < LOD_MAX_SEG) seg <<= 1;
+    return seg;
+}
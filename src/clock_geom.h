@@ -0,0 +1,324 @@
+// src/clock_geom.h
+// Clock geometry generation (clock2d_geom): GL-free, so the generators can
+// be baked at compile time, regenerated at runtime, or benchmarked alone.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <array>
+
+// ================= Mesh =================
+// A base vertex and an index range in some vertex/index table (indices are
+// local to the mesh). Field types match GLint/GLsizei.
+struct Mesh {
+    int32_t baseVertex=0;
+    int32_t firstIndex=0;
+    int32_t count=0;      // indices
+};
+
+// ================= Geometry utils =================
+// Generators are constexpr templates over a geometry sink, so the same code
+// bakes the static clock at compile time (FixedGeometry), just counts it
+// (GeometryCounter), or writes into preallocated memory (SpanGeometry).
+// A sink provides:
+//   begin()        start a mesh; vert() indices are relative to this point
+//   vert(x,y)      append a vertex, returns its local index
+//   tri(a,b,c)     append a triangle of local indices
+//   end() -> Mesh  close the mesh
+struct GeometryCounter {
+    int nv=0, ni=0, base=0, first=0;
+    constexpr void begin(){ base = nv; first = ni; }
+    constexpr uint16_t vert(float, float){ return (uint16_t)(nv++ - base); }
+    constexpr void tri(uint16_t, uint16_t, uint16_t){ ni += 3; }
+    constexpr Mesh end() const { return Mesh{ base, first, ni - first }; }
+};
+
+template<int NV, int NI>
+struct FixedGeometry {
+    std::array<float, 2*NV> v{};  // xy pairs
+    std::array<uint16_t, NI> idx{};
+    int nv=0, ni=0, base=0, first=0;
+    constexpr void begin(){ base = nv; first = ni; }
+    constexpr uint16_t vert(float x, float y){
+        v[2*nv] = x; v[2*nv+1] = y;
+        return (uint16_t)(nv++ - base);
+    }
+    constexpr void tri(uint16_t a, uint16_t b, uint16_t c){
+        idx[ni++] = a; idx[ni++] = b; idx[ni++] = c;
+    }
+    constexpr Mesh end() const { return Mesh{ base, first, ni - first }; }
+};
+
+// Runtime sink for geometry regenerated on the fly (LOD). Reserve it once
+// for the largest case and it never reallocates afterwards.
+struct GeometryBuffer {
+    std::vector<float>    v;   // xy pairs
+    std::vector<uint16_t> idx;
+    int base=0, first=0;
+    void clear(){ v.clear(); idx.clear(); base = first = 0; }
+    void begin(){ base = (int)(v.size()/2); first = (int)idx.size(); }
+    uint16_t vert(float x, float y){
+        v.push_back(x); v.push_back(y);
+        return (uint16_t)(v.size()/2 - 1 - base);
+    }
+    void tri(uint16_t a, uint16_t b, uint16_t c){
+        idx.push_back(a); idx.push_back(b); idx.push_back(c);
+    }
+    Mesh end() const { return Mesh{ base, first, (int32_t)idx.size() - first }; }
+};
+
+// Bump sink over caller-owned storage, e.g. a mapped GL buffer. Size it
+// with a GeometryCounter pass of the same generators first; it never
+// allocates, and stops writing (overflow) rather than run past the end.
+struct SpanGeometry {
+    float*    v=nullptr;   // xy pairs, capV of them
+    uint16_t* idx=nullptr;
+    int capV=0, capI=0;
+    int nv=0, ni=0, base=0, first=0;
+    bool overflow=false;
+    void begin(){ base = nv; first = ni; }
+    uint16_t vert(float x, float y){
+        if(nv < capV){ v[2*nv] = x; v[2*nv+1] = y; } else overflow = true;
+        return (uint16_t)(nv++ - base);
+    }
+    void tri(uint16_t a, uint16_t b, uint16_t c){
+        if(ni + 3 <= capI){ idx[ni] = a; idx[ni+1] = b; idx[ni+2] = c; } else overflow = true;
+        ni += 3;
+    }
+    Mesh end() const { return Mesh{ base, first, ni - first }; }
+};
+
+// constexpr sin/cos: fold into [-pi/2, pi/2], then Taylor to x^15
+// (truncation error < 1e-9 there, far below float precision).
+constexpr double CX_PI = 3.14159265358979323846;
+constexpr double cxSin(double x){
+    x -= 2*CX_PI * (double)(long long)(x / (2*CX_PI));
+    if(x >  CX_PI)   x -= 2*CX_PI;
+    if(x < -CX_PI)   x += 2*CX_PI;
+    if(x >  CX_PI/2) x =  CX_PI - x;
+    if(x < -CX_PI/2) x = -CX_PI - x;
+    double x2 = x*x, term = x, sum = x;
+    for(int k=1; k<8; k++){ term *= -x2/((2*k)*(2*k+1)); sum += term; }
+    return sum;
+}
+constexpr double cxCos(double x){ return cxSin(x + CX_PI/2); }
+
+template<class G>
+constexpr void addTri(G& g, float x1,float y1,float x2,float y2,float x3,float y3){
+    uint16_t a=g.vert(x1,y1), b=g.vert(x2,y2), c=g.vert(x3,y3);
+    g.tri(a,b,c);
+}
+// four corners in winding order -> 4 verts, 2 tris
+template<class G>
+constexpr void addQuad(G& g, float x0,float y0,float x1,float y1,float x2,float y2,float x3,float y3){
+    uint16_t a=g.vert(x0,y0), b=g.vert(x1,y1), c=g.vert(x2,y2), d=g.vert(x3,y3);
+    g.tri(a,b,c);
+    g.tri(a,c,d);
+}
+template<class G>
+constexpr void addBox(G& g, float x0,float y0,float x1,float y1){
+    addQuad(g, x0,y0, x1,y0, x1,y1, x0,y1);
+}
+template<class G>
+constexpr void genDisc(G& g, int seg=128, float r=1.0f){
+    uint16_t c = g.vert(0,0);
+    for(int i=0;i<seg;i++){
+        double a = 2.0*CX_PI*(i/(double)seg);
+        g.vert(float(r*cxCos(a)), float(r*cxSin(a)));
+    }
+    for(int i=0;i<seg;i++) g.tri(c, uint16_t(c+1+i), uint16_t(c+1+(i+1)%seg));
+}
+template<class G>
+constexpr void genRing(G& g, int seg, float r0, float r1){
+    uint16_t base = 0;
+    for(int i=0;i<seg;i++){
+        double a = 2.0*CX_PI*(i/(double)seg);
+        float c=float(cxCos(a)), s=float(cxSin(a));
+        uint16_t in = g.vert(c*r0, s*r0); // 2i   inner
+        g.vert(c*r1, s*r1);               // 2i+1 outer
+        if(i==0) base = in;
+    }
+    // two tris per slice
+    for(int i=0;i<seg;i++){
+        uint16_t i0=uint16_t(base+2*i), o0=uint16_t(i0+1);
+        uint16_t i1=uint16_t(base+2*((i+1)%seg)), o1=uint16_t(i1+1);
+        g.tri(i0, o0, o1);
+        g.tri(i0, o1, i1);
+    }
+}
+// radial tick (filled quad) centered on angle 'a', from innerR..outerR with tangential half-width 'halfW'
+template<class G>
+constexpr void addRadialBar(G& g, double a, float innerR, float outerR, float halfW){
+    float ca=float(cxCos(a)), sa=float(cxSin(a));
+    float tx=-sa, ty=ca; // tangent unit
+    // four corners (inner/outer, left/right)
+    float ix=ca*innerR, iy=sa*innerR;
+    float ox=ca*outerR, oy=sa*outerR;
+    float ilx=ix - tx*halfW, ily=iy - ty*halfW;
+    float irx=ix + tx*halfW, iry=iy + ty*halfW;
+    float olx=ox - tx*halfW, oly=oy - ty*halfW;
+    float orx=ox + tx*halfW, ory=oy + ty*halfW;
+    addQuad(g, ilx,ily, irx,iry, orx,ory, olx,oly);
+}
+template<class G>
+constexpr void genTicksQuads(G& g, int count, float innerR, float outerR, float width){
+    float halfW = width*0.5f;
+    for(int i=0;i<count;i++){
+        double a = 2.0*CX_PI*(i/(double)count);
+        addRadialBar(g, a, innerR, outerR, halfW);
+    }
+}
+
+// ================= Clock shape =================
+// Every dimension a theme may change, in NDC units of a dial of radius 1.
+// The defaults are the stock clock, which is what gets baked.
+struct TickSpec { int count; float inner, outer, width; };
+struct HandSpec { float length, width, tail; };
+constexpr int MAX_TICKS = 240; // per tick ring; sizes the runtime buffers
+
+struct ClockShape {
+    float bezelInner=0.86f, bezelOuter=0.98f;   // the face fills bezelInner
+    float ringInner=0.82f,  ringOuter=0.84f;    // chapter ring
+    TickSpec minuteTicks{ 60, 0.82f, 0.88f, 0.010f };
+    TickSpec hourTicks  { 12, 0.78f, 0.90f, 0.020f };
+    HandSpec hour  { 0.50f, 0.10f,  0.06f };
+    HandSpec minute{ 0.72f, 0.06f,  0.08f };
+    HandSpec second{ 0.82f, 0.018f, 0.15f };
+    float hubRadius=0.030f;
+    float numeralRadius=0.73f, numeralScale=0.10f;
+};
+
+// ================= Hands (resized to fit) =================
+// Hour: short spade-like rectangle + short tail
+template<class G>
+constexpr void genHourHand(G& v, const HandSpec& h = ClockShape{}.hour){
+    addBox(v, -0.5f*h.width, 0.0f,    0.5f*h.width, h.length);
+    addBox(v, -0.5f*h.width,-h.tail,  0.5f*h.width, 0.0f);
+}
+// Minute: longer, tapered pointer + small tail
+template<class G>
+constexpr void genMinuteHand(G& v, const HandSpec& h = ClockShape{}.minute){
+    const float L = h.length, W = h.width;
+    addBox(v, -0.5f*W, 0.0f,    0.5f*W, L-0.10f);
+    addTri(v, -0.45f*W, L-0.10f,  0.45f*W, L-0.10f,  0.0f, L);
+    addBox(v, -0.5f*W,-h.tail,  0.5f*W, 0.0f);
+}
+// Second: thin needle + counterweight tail + small hub
+template<class G>
+constexpr void genSecondHand(G& v, const HandSpec& h = ClockShape{}.second, float hubR = ClockShape{}.hubRadius){
+    addBox(v, -0.5f*h.width, 0.0f,    0.5f*h.width, h.length); // needle
+    addBox(v, -0.5f*h.width,-h.tail,  0.5f*h.width, 0.0f);     // tail
+    genDisc(v, 32, hubR);                                      // hub disc
+}
+
+// ================= Numerals (filled block digits) =================
+// Compact, high-contrast block numerals in [-0.5..0.5]^2
+template<class G>
+constexpr void genDigitMesh(G& v, int d){
+    auto box = [&](float x0,float y0,float x1,float y1){ addBox(v,x0,y0,x1,y1); };
+    switch(d){
+        case 0: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f);
+                box(-0.45f,-0.55f,-0.25f, 0.55f);
+                box( 0.25f,-0.55f, 0.45f, 0.55f); break;
+        case 1: box( 0.10f,-0.55f, 0.30f, 0.55f); break; // slimmer '1' for clarity
+        case 2: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box( 0.25f, 0.15f, 0.45f, 0.35f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box(-0.45f,-0.55f,-0.25f,-0.35f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
+        case 3: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box( 0.25f, 0.15f, 0.45f, 0.35f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box( 0.25f,-0.35f, 0.45f,-0.15f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
+        case 4: box(-0.45f, 0.05f,-0.25f, 0.55f);
+                box( 0.25f, 0.05f, 0.45f, 0.55f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box( 0.25f,-0.55f, 0.45f,-0.05f); break;
+        case 5: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box(-0.45f, 0.15f,-0.25f, 0.35f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box( 0.25f,-0.35f, 0.45f,-0.15f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
+        case 6: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box(-0.45f,-0.05f,-0.25f, 0.35f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box( 0.25f,-0.35f, 0.45f,-0.15f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f);
+                // add a small vertical to clarify '6'
+                box(-0.45f, -0.35f, -0.25f, -0.15f); break;
+        case 7: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box( 0.25f,-0.55f, 0.45f, 0.35f); break;
+        case 8: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box(-0.45f,-0.55f, 0.45f,-0.35f);
+                box(-0.45f,-0.55f,-0.25f, 0.55f);
+                box( 0.25f,-0.55f, 0.45f, 0.55f); break;
+        case 9: box(-0.45f, 0.35f, 0.45f, 0.55f);
+                box(-0.45f, 0.15f,-0.25f, 0.55f);
+                box(-0.45f,-0.05f, 0.45f, 0.15f);
+                box( 0.25f,-0.55f, 0.45f,-0.15f); break;
+    }
+}
+
+// ================= Clock geometry =================
+// Every static mesh of the clock, in one sink: ticks, hands, digit glyphs,
+// and the unit quad every atlas glyph is drawn with.
+// The bezel, face and chapter ring are tessellated separately at a
+// resolution-dependent segment count (lodSegments).
+struct ClockMeshes {
+    Mesh minuteTicks, hourTicks;
+    Mesh hourHand, minuteHand, secondHand;
+    Mesh glyphs[10];
+    Mesh quad;                  // [-0.5..0.5]^2
+};
+
+// Theme-dependent groups; each can be regenerated on its own.
+template<class G>
+constexpr void genTickMeshes(G& g, const ClockShape& s, Mesh& minute, Mesh& hour){
+    // Ticks (filled quads so they’re crisp on macOS)
+    const TickSpec& m = s.minuteTicks;
+    const TickSpec& h = s.hourTicks;
+    g.begin(); genTicksQuads(g, m.count, m.inner, m.outer, m.width); minute = g.end(); // thin
+    g.begin(); genTicksQuads(g, h.count, h.inner, h.outer, h.width); hour   = g.end(); // bold
+}
+template<class G>
+constexpr void genHandMeshes(G& g, const ClockShape& s, Mesh& hour, Mesh& minute, Mesh& second){
+    g.begin(); genHourHand(g, s.hour);                  hour   = g.end();
+    g.begin(); genMinuteHand(g, s.minute);              minute = g.end();
+    g.begin(); genSecondHand(g, s.second, s.hubRadius); second = g.end();
+}
+
+template<class G>
+constexpr ClockMeshes genClockGeometry(G& g, const ClockShape& s = ClockShape{}){
+    ClockMeshes m{};
+    genTickMeshes(g, s, m.minuteTicks, m.hourTicks);
+    genHandMeshes(g, s, m.hourHand, m.minuteHand, m.secondHand);
+    // Digit glyphs shared by all numerals
+    for(int d=0; d<10; d++){ g.begin(); genDigitMesh(g, d); m.glyphs[d] = g.end(); }
+    g.begin(); addBox(g, -0.5f, -0.5f, 0.5f, 0.5f); m.quad = g.end();
+    return m;
+}
+
+// ================= Tessellation LOD =================
+// Segment counts follow the on-screen radius: the smallest power of two
+// whose chord sagitta r*(1-cos(pi/n)) stays under LOD_MAX_ERROR_PX.
+constexpr float LOD_MAX_ERROR_PX = 0.25f;
+constexpr int   LOD_MIN_SEG = 16;
+constexpr int   LOD_MAX_SEG = 1024;
+
+int lodSegments(float rpx);
+
+// ================= Numeral layout =================
+// Centers of the numerals 1..12 (12 at the top); their text is laid out
+// around these by the glyph atlas.
+template<class F>
+void forEachNumeral(float rNum, F&& emit){
+    const double TAU = 6.28318530718;
+    for(int n=1;n<=12;n++){
+        float ang = float(-TAU*((n%12)/12.0) + TAU*0.25); // 12→top
+        emit(n, std::cos(ang)*rNum, std::sin(ang)*rNum);
+    }
+}
@@ -0,0 +1,310 @@
+// src/complications.cpp
+#include "complications.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static const double  TAU = 6.28318530718;
+static const int64_t NS  = 1000000000;
+
+static int64_t floorDiv(int64_t a, int64_t b){ return a/b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+static int64_t floorMod(int64_t a, int64_t b){ return a - floorDiv(a, b)*b; }
+
+// Next multiple of `period` in the dial's local time, as UTC ns
+static int64_t nextLocalBoundary(const ComplicationTime& t, int64_t period){
+    const int64_t local = t.utcNs + t.offset*NS;
+    return (floorDiv(local, period) + 1)*period - t.offset*NS;
+}
+static int64_t localDays(const ComplicationTime& t){
+    return floorDiv(floorDiv(t.utcNs, NS) + t.offset, 86400);
+}
+// Day of the month for days since 1970-01-01 (H. Hinnant's civil_from_days)
+static unsigned dayOfMonth(int64_t z){
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era*146097);
+    const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+    const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+    const unsigned mp  = (5*doy + 2)/153;
+    return doy - (153*mp + 2)/5 + 1;
+}
+
+// ================= Shared parts =================
+static void addFace(std::vector<ComplicationInstance>& face, const Mesh& m, int color){
+    ComplicationInstance in;
+    in.mesh = m; in.color = color;
+    face.push_back(in);
+}
+// Outline and ticks of a round sub-dial; `major` of the `ticks` are longer.
+static void subdialFace(GeometryBuffer& g, std::vector<ComplicationInstance>& face, float r, int ticks, int major){
+    g.begin(); genRing(g, 96, r - 0.008f, r);                     addFace(face, g.end(), CC_RING);
+    g.begin(); genTicksQuads(g, ticks, 0.80f*r, 0.92f*r, 0.005f); addFace(face, g.end(), CC_TICKS);
+    g.begin(); genTicksQuads(g, major, 0.66f*r, 0.92f*r, 0.010f); addFace(face, g.end(), CC_TICKS);
+}
+// Pointer along +y with a short tail and a hub
+static Mesh subdialHand(GeometryBuffer& g, float length, float width){
+    g.begin();
+    addBox(g, -0.5f*width, -0.2f*length, 0.5f*width, length);
+    genDisc(g, 24, 1.5f*width);
+    return g.end();
+}
+// `text` centered on (x, y) at cap height `cap` (shrunk to fit maxWidth),
+// into n glyph instances; the ones left over collapse to nothing.
+static void placeText(const GlyphAtlas& atlas, const char* text, float x, float y, float cap, float maxWidth,
+                      ComplicationInstance* out, int n){
+    std::vector<PlacedGlyph> run;
+    const float w = layoutText(atlas, text, run);
+    if(w*cap > maxWidth) cap = maxWidth/w;
+    for(int i=0; i<n; i++){
+        ComplicationInstance& in = out[i];
+        in.sx = in.sy = 0.0f;
+        if(i >= (int)run.size()) continue;
+        in.glyph = run[i].cell;
+        in.sx = in.sy = GlyphAtlas::CELL_CAPS*cap;
+        in.x = x + (run[i].x - 0.5f*w)*cap;
+        in.y = y + (run[i].y - 0.5f)*cap;
+    }
+}
+
+// ================= 24-hour hand =================
+// One turn a day, 24 at the top; moves once a minute.
+struct TwentyFourHour : Complication {
+    void declare(GeometryBuffer& geo, const GlyphAtlas& atlas,
+                 std::vector<ComplicationInstance>& face, std::vector<ComplicationInstance>& live) override {
+        subdialFace(geo, face, radius, 24, 4);
+        static const char* const LABELS[4] = { "24", "6", "12", "18" }; // top, right, bottom, left
+        for(int i=0; i<4; i++){
+            const double a = TAU*0.25 - TAU*i/4.0;
+            ComplicationInstance text[2];
+            for(ComplicationInstance& in : text) in.color = CC_TEXT;
+            placeText(atlas, LABELS[i], 0.44f*radius*(float)std::cos(a), 0.44f*radius*(float)std::sin(a),
+                      0.2f*radius, 0.6f*radius, text, 2);
+            for(const ComplicationInstance& in : text) if(in.sx > 0.0f) face.push_back(in);
+        }
+        ComplicationInstance hand;
+        hand.mesh = subdialHand(geo, 0.78f*radius, 0.012f);
+        live.push_back(hand);
+    }
+    void update(const ComplicationTime& t, ComplicationInstance* live) override {
+        const int64_t minute = floorMod(floorDiv(t.utcNs, NS) + t.offset, 86400)/60;
+        live[0].angle = float(-TAU*minute/1440.0);
+    }
+    int64_t nextChange(const ComplicationTime& t) const override { return nextLocalBoundary(t, 60*NS); }
+};
+
+// ================= Stopwatch =================
+// Seconds hand and a 60-minute counter; Space starts/stops, R resets. It
+// runs on the frame timeline, so bench and export runs are deterministic.
+struct Stopwatch : Complication {
+    bool    running = false;
+    int64_t startNs = 0, accumNs = 0;
+
+    int64_t elapsed(int64_t utcNs) const { return accumNs + (running ? std::max<int64_t>(0, utcNs - startNs) : 0); }
+    void declare(GeometryBuffer& geo, const GlyphAtlas&,
+                 std::vector<ComplicationInstance>& face, std::vector<ComplicationInstance>& live) override {
+        subdialFace(geo, face, radius, 60, 12);
+        ComplicationInstance minutes, seconds;
+        minutes.mesh = subdialHand(geo, 0.55f*radius, 0.012f);
+        seconds.mesh = subdialHand(geo, 0.86f*radius, 0.007f);
+        seconds.color = CC_ACCENT;
+        live.push_back(minutes);
+        live.push_back(seconds);
+    }
+    void update(const ComplicationTime& t, ComplicationInstance* live) override {
+        const int64_t s = elapsed(t.utcNs)/NS;
+        live[0].angle = float(-TAU*((s/60 % 60) + (s % 60)/60.0)/60.0);
+        live[1].angle = float(-TAU*(s % 60)/60.0);
+    }
+    int64_t nextChange(const ComplicationTime& t) const override {
+        return running ? t.utcNs + NS - elapsed(t.utcNs) % NS : INT64_MAX;
+    }
+    bool key(int key, int64_t utcNs) override {
+        if(key == ' '){
+            if(running) accumNs = elapsed(utcNs);
+            else        startNs = utcNs;
+            running = !running;
+            return true;
+        }
+        if(key == 'R'){
+            accumNs = 0;
+            startNs = utcNs;
+            return true;
+        }
+        return false;
+    }
+};
+
+// ================= Moon phase =================
+// An accent-colored moon on a sky in the hands' color. The lit part is a
+// half disc plus a half ellipse on the terminator, both scaled copies of
+// one half-disc mesh: sky over the lit half while crescent, lit beside it
+// while gibbous. Redrawn STEPS times a lunation.
+struct MoonPhase : Complication {
+    static constexpr int64_t NEW_MOON_NS = INT64_C(947181240)*NS;       // 2000-01-06 18:14 UTC
+    static constexpr int64_t SYNODIC_NS  = INT64_C(2551442877)*1000000; // 29.530588853 days
+    static const int STEPS = 120;                                       // ~6 h apart
+    static constexpr int64_t STEP_NS = SYNODIC_NS/STEPS;
+
+    void declare(GeometryBuffer& geo, const GlyphAtlas&,
+                 std::vector<ComplicationInstance>& face, std::vector<ComplicationInstance>& live) override {
+        geo.begin(); genRing(geo, 96, radius - 0.008f, radius); addFace(face, geo.end(), CC_RING);
+        geo.begin(); genDisc(geo, 96, 0.84f*radius);            addFace(face, geo.end(), CC_HAND); // night sky
+        Mesh half; // unit half disc, x >= 0
+        geo.begin();
+        const int SEG = 48;
+        const uint16_t c = geo.vert(0.0f, 0.0f);
+        for(int i=0; i<=SEG; i++){
+            const double a = -TAU*0.25 + TAU*0.5*i/SEG;
+            geo.vert((float)std::cos(a), (float)std::sin(a));
+        }
+        for(int i=0; i<SEG; i++) geo.tri(c, uint16_t(c+1+i), uint16_t(c+2+i));
+        half = geo.end();
+        ComplicationInstance in;
+        in.mesh = half;
+        live.push_back(in);
+        live.push_back(in);
+    }
+    void update(const ComplicationTime& t, ComplicationInstance* live) override {
+        const int64_t step = floorMod(t.utcNs - NEW_MOON_NS, SYNODIC_NS)/STEP_NS;
+        const double  p = (step + 0.5)/STEPS;            // 0 new, 0.5 full
+        const float   r = 0.74f*radius, side = p < 0.5 ? 1.0f : -1.0f;
+        const float   e = (float)std::cos(TAU*p);        // terminator's x semi-axis / r
+        live[0].sx = side*r;   live[0].sy = r; live[0].color = CC_ACCENT;
+        live[1].sx = side*r*e; live[1].sy = r; live[1].color = e > 0.0f ? CC_HAND : CC_ACCENT;
+    }
+    int64_t nextChange(const ComplicationTime& t) const override {
+        const int64_t age = floorMod(t.utcNs - NEW_MOON_NS, SYNODIC_NS);
+        return t.utcNs - age + std::min((age/STEP_NS + 1)*STEP_NS, SYNODIC_NS);
+    }
+};
+
+// ================= Date window =================
+// Weekday and day of the month in a framed window; changes at local midnight.
+struct DateWindow : Complication {
+    static const int GLYPHS = 6; // "WED 14"
+    static constexpr float W = 0.30f, H = 0.09f, FRAME = 0.008f;
+    const GlyphAtlas* atlas = nullptr;
+
+    void declare(GeometryBuffer& geo, const GlyphAtlas& a,
+                 std::vector<ComplicationInstance>& face, std::vector<ComplicationInstance>& live) override {
+        atlas = &a;
+        const float x = 0.5f*W, y = 0.5f*H;
+        geo.begin();
+        addBox(geo, -x, y - FRAME,  x, y);
+        addBox(geo, -x, -y,         x, -y + FRAME);
+        addBox(geo, -x, -y, -x + FRAME, y);
+        addBox(geo,  x - FRAME, -y, x, y);
+        addFace(face, geo.end(), CC_RING);
+        ComplicationInstance glyph;
+        glyph.glyph = 0; glyph.sx = glyph.sy = 0.0f; glyph.color = CC_TEXT;
+        live.insert(live.end(), GLYPHS, glyph);
+    }
+    void update(const ComplicationTime& t, ComplicationInstance* live) override {
+        static const char* const WEEKDAYS[7] = { "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT" };
+        const int64_t days = localDays(t);
+        char text[16];
+        std::snprintf(text, sizeof(text), "%s %u", WEEKDAYS[floorMod(days + 4, 7)], dayOfMonth(days)); // 1970-01-01: Thursday
+        placeText(*atlas, text, 0.0f, 0.0f, 0.05f, W - 4.0f*FRAME, live, GLYPHS);
+    }
+    int64_t nextChange(const ComplicationTime& t) const override { return nextLocalBoundary(t, 86400*NS); }
+};
+
+// ================= Set =================
+template<class C> static std::unique_ptr<Complication> make(){ return std::unique_ptr<Complication>(new C); }
+
+bool ComplicationSet::parse(const char* spec){
+    static const char* const SLOT_NAMES[SLOTS] = { "top", "right", "bottom", "left" };
+    static const float SLOT_DIR[SLOTS][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+    static const struct { const char* name; int slot; std::unique_ptr<Complication> (*make)(); } KINDS[] = {
+        { "24h", 3, make<TwentyFourHour> }, { "stopwatch", 2, make<Stopwatch> },
+        { "moon", 0, make<MoonPhase> },     { "date", 1, make<DateWindow> },
+    };
+    bool taken[SLOTS] = {};
+    for(const char* p = spec; *p; ){
+        const char* end = std::strchr(p, ',');
+        std::string item(p, end ? end : p + std::strlen(p));
+        p = end ? end + 1 : p + item.size();
+        std::string slotName;
+        const size_t at = item.find('@');
+        if(at != std::string::npos){ slotName = item.substr(at + 1); item.resize(at); }
+
+        int kind = -1, slot = -1;
+        for(int k=0; k<(int)(sizeof(KINDS)/sizeof(KINDS[0])); k++) if(item == KINDS[k].name) kind = k;
+        if(kind < 0){
+            std::fprintf(stderr, "--complications: unknown '%s' (expected 24h, stopwatch, moon or date)\n", item.c_str());
+            return false;
+        }
+        slot = KINDS[kind].slot;
+        if(!slotName.empty()){
+            slot = -1;
+            for(int s=0; s<SLOTS; s++) if(slotName == SLOT_NAMES[s]) slot = s;
+            if(slot < 0){
+                std::fprintf(stderr, "--complications: unknown slot '%s' (expected top, right, bottom or left)\n", slotName.c_str());
+                return false;
+            }
+        }
+        if(taken[slot]){
+            std::fprintf(stderr, "--complications: two in the %s slot\n", SLOT_NAMES[slot]);
+            return false;
+        }
+        taken[slot] = true;
+        std::unique_ptr<Complication> c = KINDS[kind].make();
+        c->cx = SLOT_OFFSET*SLOT_DIR[slot][0];
+        c->cy = SLOT_OFFSET*SLOT_DIR[slot][1];
+        c->radius = SLOT_RADIUS;
+        items.push_back(std::move(c));
+    }
+    return true;
+}
+
+void ComplicationSet::declare(const GlyphAtlas& atlas, int dialCount){
+    dials = dialCount;
+    std::vector<ComplicationInstance> first; // dial 0's live instances
+    liveFirst.assign(1, 0);
+    for(auto& c : items){
+        const size_t f = face.size();
+        c->declare(geometry, atlas, face, first);
+        for(size_t i=f; i<face.size(); i++){ face[i].x += c->cx; face[i].y += c->cy; }
+        liveFirst.push_back((int)first.size());
+    }
+    liveCount = (int)first.size();
+    live.clear();
+    for(int d=0; d<dials; d++) live.insert(live.end(), first.begin(), first.end());
+    due.assign(items.size()*dials, INT64_MIN);
+    evaluated.assign(items.size()*dials, INT64_MIN);
+    changed.assign(items.size()*dials, 0);
+}
+
+bool ComplicationSet::update(int d, const ComplicationTime& t){
+    bool any = false;
+    for(size_t i=0; i<items.size(); i++){
+        const size_t k = d*items.size() + i;
+        // a clock stepped backwards invalidates every deadline
+        changed[k] = t.utcNs >= due[k] || t.utcNs < evaluated[k];
+        if(!changed[k]) continue;
+        items[i]->update(t, liveOf(d, (int)i));
+        due[k] = items[i]->nextChange(t);
+        evaluated[k] = t.utcNs;
+        any = true;
+    }
+    return any;
+}
+
+bool ComplicationSet::key(int key, int64_t utcNs){
+    bool any = false;
+    for(size_t i=0; i<items.size(); i++){
+        if(!items[i]->key(key, utcNs)) continue;
+        for(int d=0; d<dials; d++) due[d*items.size() + i] = INT64_MIN;
+        any = true;
+    }
+    return any;
+}
+
+int64_t ComplicationSet::nextDeadline() const {
+    int64_t t = INT64_MAX;
+    for(int64_t d : due) t = std::min(t, d);
+    return t;
+}
@@ -0,0 +1,83 @@
+// src/complications.h
+// Complications: sub-dials and windows that show more than the time of day
+// (24-hour hand, stopwatch, moon phase, date). Each one declares its meshes
+// once, describes itself as instances of them, and reports when its look
+// next changes. The render loop batches every dial's instances into one
+// draw and re-evaluates only the complications whose deadline has passed,
+// so a face full of them costs nothing between changes. GL-free: main.cpp
+// turns instances into render-list records and deadlines into wake-ups.
+#pragma once
+
+#include "clock_geom.h"
+#include "glyph_atlas.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Color roles; main.cpp resolves them through the theme.
+enum ComplicationColor { CC_FACE, CC_RING, CC_TICKS, CC_TEXT, CC_HAND, CC_ACCENT, CC_COUNT };
+
+// One mesh placed on the dial: rotated by `angle` (radians, counter-
+// clockwise), scaled, then moved to (x, y) from the complication's
+// center, in dial units. A glyph instance draws an atlas cell on the
+// renderer's unit quad instead of `mesh`. Live instances keep their mesh
+// and glyph-ness; update() changes everything else.
+struct ComplicationInstance {
+    Mesh  mesh;       // in ComplicationSet::geometry
+    float angle=0.0f, sx=1.0f, sy=1.0f, x=0.0f, y=0.0f;
+    int   glyph=-1;   // atlas cell, -1 for a solid mesh
+    int   color=CC_HAND;
+};
+
+struct ComplicationTime {
+    int64_t utcNs=0;
+    int64_t offset=0; // the dial's local - UTC, seconds
+};
+
+struct Complication {
+    float cx=0.0f, cy=0.0f; // center on the dial, set before declare()
+    float radius=0.0f;      // everything it draws stays inside this circle
+
+    virtual ~Complication() = default;
+    // Once: meshes into `geo`, the instances that never change into `face`
+    // (drawn into the cached dial), and the ones update() rewrites into `live`.
+    virtual void declare(GeometryBuffer& geo, const GlyphAtlas& atlas,
+                         std::vector<ComplicationInstance>& face, std::vector<ComplicationInstance>& live) = 0;
+    // Rewrites the instances declared live, for time t.
+    virtual void update(const ComplicationTime& t, ComplicationInstance* live) = 0;
+    // First UTC ns after t.utcNs at which update() would differ; INT64_MAX
+    // if only input can change it.
+    virtual int64_t nextChange(const ComplicationTime& t) const = 0;
+    // A key press (GLFW key code: printable keys are their uppercase ASCII)
+    // at UTC ns; true if the look changed.
+    virtual bool key(int, int64_t){ return false; }
+};
+
+struct ComplicationSet {
+    static const int SLOTS = 4;                  // top, right, bottom, left
+    static constexpr float SLOT_OFFSET = 0.40f;  // slot center from the dial center
+    static constexpr float SLOT_RADIUS = 0.17f;
+
+    std::vector<std::unique_ptr<Complication>> items;
+    GeometryBuffer geometry;                    // every item's meshes
+    std::vector<ComplicationInstance> face;     // identical on every dial; moved to dial coordinates
+    std::vector<ComplicationInstance> live;     // liveCount per dial, dial after dial
+    std::vector<int>     liveFirst;             // per item, within a dial; back() = liveCount
+    std::vector<int64_t> due;                   // per dial and item: re-evaluate at or after
+    std::vector<int64_t> evaluated;             // per dial and item: time of the last update
+    std::vector<char>    changed;               // per dial and item: by the last update()
+    int liveCount=0, dials=0;
+
+    // "kind[@slot],...": kinds 24h, stopwatch, moon, date; slots top, right,
+    // bottom, left (each kind has a default). False, with a message, if malformed.
+    bool parse(const char* spec);
+    void declare(const GlyphAtlas& atlas, int dialCount);
+    // Re-evaluates dial d's items that are due; true if any changed.
+    bool update(int d, const ComplicationTime& t);
+    // Forwards a key press; items it changes are due at once on every dial.
+    bool key(int key, int64_t utcNs);
+    int64_t nextDeadline() const;  // earliest due, over all dials
+    ComplicationInstance* liveOf(int d, int item){ return &live[d*liveCount + liveFirst[item]]; }
+    int liveSize(int item) const { return liveFirst[item+1] - liveFirst[item]; }
+};
@@ -0,0 +1,279 @@
+// src/frame_encode.cpp
+#include "frame_encode.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+bool parseFrameFormat(const char* name, FrameFormat& out){
+    static const struct { const char* name; FrameFormat f; } FORMATS[] = {
+        { "png", FF_PNG }, { "ppm", FF_PPM }, { "rgba", FF_RGBA }, { "yuv", FF_YUV420 },
+    };
+    for(const auto& e : FORMATS) if(!std::strcmp(name, e.name)){ out = e.f; return true; }
+    return false;
+}
+
+// ================= PNG =================
+// No zlib dependency: the image data goes out as stored deflate blocks.
+// Files are about 3 bytes per pixel, but encoding is just copying and
+// checksums, which keeps the worker pool ahead of GPU readback.
+static uint32_t crc32(uint32_t c, const unsigned char* p, size_t n){
+    static const struct Table {
+        uint32_t t[256];
+        Table(){
+            for(uint32_t i=0; i<256; i++){
+                uint32_t c = i;
+                for(int k=0; k<8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+        }
+    } table;
+    c = ~c;
+    for(size_t i=0; i<n; i++) c = table.t[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return ~c;
+}
+
+// Running sums over runs of up to 5552 bytes, the most that cannot
+// overflow 32 bits before the modulo (zlib's NMAX)
+static void adler32(uint32_t& a, uint32_t& b, const unsigned char* p, size_t n){
+    while(n){
+        const size_t k = n < 5552 ? n : 5552;
+        for(size_t i=0; i<k; i++){ a += p[i]; b += a; }
+        a %= 65521; b %= 65521;
+        p += k; n -= k;
+    }
+}
+
+static void put32(std::vector<unsigned char>& out, uint32_t v){
+    const unsigned char b[4] = { (unsigned char)(v>>24), (unsigned char)(v>>16), (unsigned char)(v>>8), (unsigned char)v };
+    out.insert(out.end(), b, b+4);
+}
+
+// Appends a chunk whose payload is already at out[start+8 ...].
+static void closeChunk(std::vector<unsigned char>& out, size_t start){
+    const uint32_t len = (uint32_t)(out.size() - start - 8);
+    for(int i=0; i<4; i++) out[start+i] = (unsigned char)(len >> (24 - 8*i));
+    put32(out, crc32(0, &out[start+4], len + 4));
+}
+static size_t openChunk(std::vector<unsigned char>& out, const char type[4]){
+    size_t start = out.size();
+    put32(out, 0);
+    out.insert(out.end(), type, type+4);
+    return start;
+}
+
+static void encodePng(const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out){
+    static const unsigned char SIG[8] = { 0x89,'P','N','G','\r','\n',0x1A,'\n' };
+    out.assign(SIG, SIG+8);
+
+    size_t c = openChunk(out, "IHDR");
+    put32(out, (uint32_t)w); put32(out, (uint32_t)h);
+    const unsigned char ihdr[5] = { 8, 2, 0, 0, 0 }; // 8-bit RGB, no interlace
+    out.insert(out.end(), ihdr, ihdr+5);
+    closeChunk(out, c);
+
+    // zlib stream: header, stored blocks of filter-0 scanlines, Adler-32.
+    // Scanlines are built one at a time and copied out in runs that end at
+    // a block boundary or the row's end.
+    const size_t row = 1 + 3*(size_t)w, raw = row*(size_t)h;
+    c = openChunk(out, "IDAT");
+    out.reserve(out.size() + raw + raw/65535*5 + 64);
+    out.push_back(0x78); out.push_back(0x01);
+    std::vector<unsigned char> line(row, 0); // line[0]: filter 0
+    uint32_t a = 1, b = 0;
+    size_t blockLeft = 0, total = 0;
+    for(int y=h-1; y>=0; y--){
+        const unsigned char* src = rgba + (size_t)y*w*4;
+        for(int x=0; x<w; x++) std::memcpy(&line[1 + 3*(size_t)x], src + 4*x, 3);
+        adler32(a, b, line.data(), row);
+        for(size_t done = 0; done < row; ){
+            if(!blockLeft){
+                blockLeft = raw - total < 65535 ? raw - total : 65535;
+                out.push_back(total + blockLeft == raw ? 1 : 0); // BFINAL, BTYPE=00
+                out.push_back((unsigned char)blockLeft);  out.push_back((unsigned char)(blockLeft >> 8));
+                out.push_back((unsigned char)~blockLeft); out.push_back((unsigned char)(~blockLeft >> 8));
+            }
+            const size_t n = std::min(blockLeft, row - done);
+            out.insert(out.end(), line.begin() + done, line.begin() + done + n);
+            done += n; total += n; blockLeft -= n;
+        }
+    }
+    put32(out, (b << 16) | a);
+    closeChunk(out, c);
+
+    closeChunk(out, openChunk(out, "IEND"));
+}
+
+// ================= Raw formats =================
+static void encodePpm(const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out){
+    char hdr[32];
+    int n = std::snprintf(hdr, sizeof(hdr), "P6\n%d %d\n255\n", w, h);
+    out.assign(hdr, hdr+n);
+    out.reserve(out.size() + 3*(size_t)w*h);
+    for(int y=h-1; y>=0; y--){
+        const unsigned char* src = rgba + (size_t)y*w*4;
+        for(int x=0; x<w; x++) out.insert(out.end(), src+4*x, src+4*x+3);
+    }
+}
+
+static void encodeRgba(const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out){
+    const size_t stride = 4*(size_t)w;
+    out.resize(stride*h);
+    for(int y=0; y<h; y++) std::memcpy(&out[y*stride], rgba + (size_t)(h-1-y)*stride, stride);
+}
+
+// I420: full-size Y plane, then U and V at half resolution (2x2 averages;
+// odd edges reuse the last row/column).
+static void encodeYuv420(const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out){
+    const int cw = (w+1)/2, ch = (h+1)/2;
+    out.resize((size_t)w*h + 2*(size_t)cw*ch);
+    unsigned char* Y = out.data();
+    unsigned char* U = Y + (size_t)w*h;
+    unsigned char* V = U + (size_t)cw*ch;
+    auto px = [&](int x, int y){ return rgba + ((size_t)(h-1-y)*w + x)*4; }; // top-down
+    for(int y=0; y<h; y++) for(int x=0; x<w; x++){
+        const unsigned char* p = px(x, y);
+        Y[(size_t)y*w + x] = (unsigned char)(16 + ((66*p[0] + 129*p[1] + 25*p[2] + 128) >> 8));
+    }
+    for(int y=0; y<ch; y++) for(int x=0; x<cw; x++){
+        int r=0, g=0, b=0;
+        for(int k=0; k<4; k++){
+            int sx = 2*x + (k&1), sy = 2*y + (k>>1);
+            const unsigned char* p = px(sx < w ? sx : w-1, sy < h ? sy : h-1);
+            r += p[0]; g += p[1]; b += p[2];
+        }
+        r = (r+2)/4; g = (g+2)/4; b = (b+2)/4;
+        U[(size_t)y*cw + x] = (unsigned char)(128 + ((-38*r - 74*g + 112*b + 128) >> 8));
+        V[(size_t)y*cw + x] = (unsigned char)(128 + ((112*r - 94*g - 18*b + 128) >> 8));
+    }
+}
+
+void encodeFrame(FrameFormat f, const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out){
+    switch(f){
+    case FF_PNG:    encodePng(rgba, w, h, out);    break;
+    case FF_PPM:    encodePpm(rgba, w, h, out);    break;
+    case FF_RGBA:   encodeRgba(rgba, w, h, out);   break;
+    case FF_YUV420: encodeYuv420(rgba, w, h, out); break;
+    }
+}
+
+// ================= Golden images =================
+static uint32_t get32(const unsigned char* p){
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static bool decodePpm(const std::vector<unsigned char>& file, std::vector<unsigned char>& rgba, int& w, int& h,
+                      const char*& err){
+    int maxval = 0, n = 0;
+    std::string hdr(file.begin(), file.begin() + (file.size() < 64 ? file.size() : 64));
+    if(std::sscanf(hdr.c_str(), "P6 %d %d %d%n", &w, &h, &maxval, &n) != 3 || w <= 0 || h <= 0 || maxval != 255){
+        err = "not an 8-bit binary PPM"; return false;
+    }
+    if(w > MAX_IMAGE_SIDE || h > MAX_IMAGE_SIDE){ err = "too large"; return false; }
+    const size_t px = (size_t)w*h, start = (size_t)n + 1; // one whitespace byte after maxval
+    if(file.size() < start + 3*px){ err = "truncated"; return false; }
+    rgba.resize(4*px);
+    for(size_t i=0; i<px; i++){
+        std::memcpy(&rgba[4*i], &file[start + 3*i], 3);
+        rgba[4*i+3] = 255;
+    }
+    return true;
+}
+
+// Paeth predictor (PNG spec 9.4)
+static int paeth(int a, int b, int c){
+    const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+static bool decodePng(const std::vector<unsigned char>& file, std::vector<unsigned char>& rgba, int& w, int& h,
+                      const char*& err){
+    // Chunks: IHDR, then the IDAT payloads joined
+    std::vector<unsigned char> z;
+    int channels = 0;
+    for(size_t p = 8; p + 12 <= file.size(); ){
+        const uint32_t len = get32(&file[p]);
+        if(len > file.size() - p - 12){ err = "truncated"; return false; }
+        const unsigned char* type = &file[p+4];
+        const unsigned char* data = &file[p+8];
+        if(!std::memcmp(type, "IHDR", 4) && len >= 13){
+            w = (int)get32(data); h = (int)get32(data+4);
+            if(data[8] != 8 || (data[9] != 2 && data[9] != 6) || data[12] != 0 || w <= 0 || h <= 0){
+                err = "not an 8-bit, non-interlaced RGB/RGBA PNG"; return false;
+            }
+            if(w > MAX_IMAGE_SIDE || h > MAX_IMAGE_SIDE){ err = "too large"; return false; }
+            channels = data[9] == 6 ? 4 : 3;
+        } else if(!std::memcmp(type, "IDAT", 4)){
+            z.insert(z.end(), data, data + len);
+        } else if(!std::memcmp(type, "IEND", 4)) break;
+        p += 12 + (size_t)len;
+    }
+    if(!channels){ err = "no IHDR"; return false; }
+
+    // zlib: header, stored deflate blocks to the final one
+    if(z.size() < 2 || (z[0] & 0x0F) != 8){ err = "bad zlib header"; return false; }
+    const size_t row = 1 + (size_t)channels*w;
+    if(z.size() < row*h){ err = "truncated"; return false; } // stored blocks never shrink
+    std::vector<unsigned char> raw;
+    raw.reserve(row*h);
+    for(size_t p = 2; ; ){
+        if(p + 5 > z.size()){ err = "truncated"; return false; }
+        const int head = z[p];
+        if((head >> 1 & 3) != 0){ err = "compressed PNG (only stored deflate blocks are read)"; return false; }
+        const size_t len = z[p+1] | (size_t)z[p+2] << 8;
+        if(p + 5 + len > z.size()){ err = "truncated"; return false; }
+        raw.insert(raw.end(), &z[p+5], &z[p+5] + len);
+        p += 5 + len;
+        if(head & 1) break;
+    }
+    if(raw.size() < row*h){ err = "truncated"; return false; }
+
+    // Undo the row filters in place, then widen to RGBA
+    const int bpp = channels;
+    for(int y=0; y<h; y++){
+        unsigned char* cur = &raw[y*row + 1];
+        const unsigned char* up = y ? &raw[(y-1)*row + 1] : nullptr;
+        const int filter = cur[-1];
+        if(filter > 4){ err = "bad row filter"; return false; }
+        for(size_t x=0; x+1<row; x++){
+            const int a = x >= (size_t)bpp ? cur[x-bpp] : 0, b = up ? up[x] : 0;
+            const int c = up && x >= (size_t)bpp ? up[x-bpp] : 0;
+            const int pred = filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b)/2 : filter == 4 ? paeth(a, b, c) : 0;
+            cur[x] = (unsigned char)(cur[x] + pred);
+        }
+    }
+    rgba.resize(4*(size_t)w*h);
+    for(int y=0; y<h; y++) for(int x=0; x<w; x++){
+        const unsigned char* s = &raw[y*row + 1 + (size_t)channels*x];
+        unsigned char* d = &rgba[4*((size_t)y*w + x)];
+        d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = channels == 4 ? s[3] : 255;
+    }
+    return true;
+}
+
+bool decodeImage(const std::vector<unsigned char>& file, std::vector<unsigned char>& rgba, int& w, int& h,
+                 const char*& err){
+    static const unsigned char SIG[8] = { 0x89,'P','N','G','\r','\n',0x1A,'\n' };
+    if(file.size() >= 8 && !std::memcmp(file.data(), SIG, 8)) return decodePng(file, rgba, w, h, err);
+    if(file.size() >= 2 && file[0] == 'P' && file[1] == '6') return decodePpm(file, rgba, w, h, err);
+    err = "neither PNG nor PPM";
+    return false;
+}
+
+ImageDiff compareFrame(const unsigned char* frame, const unsigned char* image, int w, int h, int tolerance){
+    ImageDiff d;
+    for(int y=0; y<h; y++){
+        const unsigned char* a = frame + (size_t)(h-1-y)*w*4; // frames are bottom-up
+        const unsigned char* b = image + (size_t)y*w*4;
+        for(int x=0; x<4*w; x+=4){
+            int m = 0;
+            for(int k=0; k<3; k++) m = std::max(m, std::abs(a[x+k] - b[x+k]));
+            if(m > tolerance) d.over++;
+            d.maxDelta = std::max(d.maxDelta, m);
+        }
+    }
+    return d;
+}
@@ -0,0 +1,37 @@
+// src/frame_encode.h
+// Encoders for exported frames (GL-free, so export workers can run them on
+// any thread). Input is tightly packed RGBA8 rows, bottom row first, exactly
+// as glReadPixels returns them; every encoder writes top-down output.
+#pragma once
+
+#include <vector>
+
+enum FrameFormat {
+    FF_PNG,     // one file per frame, RGB, stored (uncompressed) deflate
+    FF_PPM,     // one file per frame, binary P6
+    FF_RGBA,    // raw RGBA8 frames appended to one stream
+    FF_YUV420,  // raw I420 (BT.601 limited range) frames appended to one stream
+};
+
+// "png", "ppm", "rgba" or "yuv"; false on anything else.
+bool parseFrameFormat(const char* name, FrameFormat& out);
+// Raw formats concatenate into one stream; image formats write a file each.
+inline bool isStreamFormat(FrameFormat f){ return f == FF_RGBA || f == FF_YUV420; }
+
+// Replaces `out` with the encoded frame.
+void encodeFrame(FrameFormat f, const unsigned char* rgba, int w, int h, std::vector<unsigned char>& out);
+
+// ================= Golden images =================
+// Reads back what the image formats write: binary P6, or 8-bit RGB/RGBA
+// PNG made of stored deflate blocks (any row filter). Output is top-down
+// RGBA8. False, with the reason in `err`, for anything else (compressed
+// PNGs included: re-save goldens with --export, not an image editor), and
+// for sides over MAX_IMAGE_SIDE.
+static const int MAX_IMAGE_SIDE = 16384;
+bool decodeImage(const std::vector<unsigned char>& file, std::vector<unsigned char>& rgba, int& w, int& h,
+                 const char*& err);
+
+// Pixels of a frame (encodeFrame's input) whose worst RGB channel is off
+// from a decoded image of the same size by more than `tolerance`.
+struct ImageDiff { long over=0; int maxDelta=0; };
+ImageDiff compareFrame(const unsigned char* frame, const unsigned char* image, int w, int h, int tolerance);
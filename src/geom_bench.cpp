@@ -0,0 +1,93 @@
+// src/geom_bench.cpp
+// CPU micro-benchmark for clock2d_geom: vertices/s and heap allocations per
+// mesh for each generator, at several segment counts and for each sink:
+//   fresh   a new GeometryBuffer per mesh (vector growth on every call)
+//   reused  one GeometryBuffer, clear()ed between meshes (capacity kept)
+//   fixed   a FixedGeometry sized for the largest case (never allocates)
+#include "clock_geom.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <new>
+
+// ================= Allocation counter =================
+static long g_allocs = 0;
+
+void* operator new(std::size_t n){
+    g_allocs++;
+    if(void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// ================= Harness =================
+static const int MAX_SEG = LOD_MAX_SEG;
+static FixedGeometry<2*MAX_SEG + 1, 6*MAX_SEG> g_fixed; // ring: 2 verts, 6 indices per segment
+constexpr GeometryCounter CLOCK_SIZE = []{ GeometryCounter c; genClockGeometry(c); return c; }();
+static_assert(CLOCK_SIZE.nv <= 2*MAX_SEG + 1 && CLOCK_SIZE.ni <= 6*MAX_SEG, "g_fixed too small for the clock");
+
+static volatile float g_sink; // keeps results observable
+
+struct Result { double vertsPerSec; double allocsPerMesh; };
+
+// Runs gen(sink) repeatedly for ~0.1 s; gen returns the vertices it emitted.
+template<class F>
+static Result measure(F&& gen){
+    using Clock = std::chrono::steady_clock;
+    const auto budget = std::chrono::milliseconds(100);
+    long meshes = 0, verts = 0;
+    long allocs0 = g_allocs;
+    auto t0 = Clock::now(), t = t0;
+    do {
+        for(int i=0; i<64; i++){ verts += gen(); meshes++; }
+        t = Clock::now();
+    } while(t - t0 < budget);
+    double sec = std::chrono::duration<double>(t - t0).count();
+    return Result{ verts/sec, (double)(g_allocs - allocs0)/meshes };
+}
+
+template<class Gen>
+static void run(const char* name, int seg, Gen&& gen){
+    GeometryBuffer reused;
+    Result fresh = measure([&]{
+        GeometryBuffer b;
+        b.begin(); gen(b); b.end();
+        g_sink = b.v.back();
+        return (long)(b.v.size()/2);
+    });
+    Result keep = measure([&]{
+        reused.clear();
+        reused.begin(); gen(reused); reused.end();
+        g_sink = reused.v.back();
+        return (long)(reused.v.size()/2);
+    });
+    Result fixed = measure([&]{
+        g_fixed.nv = g_fixed.ni = 0;
+        g_fixed.begin(); gen(g_fixed); g_fixed.end();
+        g_sink = g_fixed.v[2*g_fixed.nv - 1];
+        return (long)g_fixed.nv;
+    });
+    const Result r[3] = { fresh, keep, fixed };
+    const char* sink[3] = { "fresh", "reused", "fixed" };
+    for(int i=0; i<3; i++){
+        std::printf("%-14s %5d  %-7s %9.1f  %8.2f\n", name, seg, sink[i],
+                    r[i].vertsPerSec*1e-6, r[i].allocsPerMesh);
+    }
+}
+
+// ================= Cases =================
+int main(){
+    std::printf("%-14s %5s  %-7s %9s  %8s\n", "mesh", "seg", "sink", "Mverts/s", "allocs");
+    for(int seg=LOD_MIN_SEG; seg<=MAX_SEG; seg*=4){
+        run("disc", seg, [&](auto& g){ genDisc(g, seg); });
+        run("ring", seg, [&](auto& g){ genRing(g, seg, 0.86f, 0.98f); });
+    }
+    run("ticks", 60,  [](auto& g){ genTicksQuads(g, 60, 0.82f, 0.88f, 0.010f); });
+    run("digits", 10, [](auto& g){ for(int d=0; d<10; d++) genDigitMesh(g, d); });
+    run("second-hand", 32, [](auto& g){ genSecondHand(g); });
+    run("clock", 0,   [](auto& g){ genClockGeometry(g); });
+    return 0;
+}
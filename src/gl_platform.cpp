@@ -0,0 +1,26 @@
+// src/gl_platform.cpp
+#include "gl_platform.h"
+
+#ifndef __APPLE__
+#include <cstdio>
+
+namespace clock2d_gl {
+#define CLOCK2D_GL_DEFINE(type, name) type name = nullptr;
+CLOCK2D_GL_FUNCTIONS(CLOCK2D_GL_DEFINE)
+CLOCK2D_GL_OPTIONAL_FUNCTIONS(CLOCK2D_GL_DEFINE)
+#undef CLOCK2D_GL_DEFINE
+}
+
+bool glLoadFunctions(){
+    bool ok = true;
+#define CLOCK2D_GL_LOAD(type, name) \
+    if(!(clock2d_gl::name = (type)glfwGetProcAddress(#name)) && ok){ \
+        std::fprintf(stderr, "[GL] missing entry point %s\n", #name); ok = false; }
+    CLOCK2D_GL_FUNCTIONS(CLOCK2D_GL_LOAD)
+#undef CLOCK2D_GL_LOAD
+#define CLOCK2D_GL_LOAD_OPTIONAL(type, name) clock2d_gl::name = (type)glfwGetProcAddress(#name);
+    CLOCK2D_GL_OPTIONAL_FUNCTIONS(CLOCK2D_GL_LOAD_OPTIONAL)
+#undef CLOCK2D_GL_LOAD_OPTIONAL
+    return ok;
+}
+#endif
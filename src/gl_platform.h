@@ -0,0 +1,123 @@
+// src/gl_platform.h
+// OpenGL headers and entry points for every platform the app builds on.
+// macOS links the OpenGL framework's GL 4.1 core functions directly.
+// Elsewhere only the Khronos <GL/glcorearb.h> is needed: the functions the
+// renderer uses are fetched once through glfwGetProcAddress after the
+// context is current (glLoadFunctions), so nothing links against a
+// particular libGL / opengl32 import library.
+// Adding a GL call to the renderer means adding it to the list below.
+#pragma once
+
+#ifdef __APPLE__
+#ifndef GL_SILENCE_DEPRECATION
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <OpenGL/gl3.h>
+#else
+#include <GL/glcorearb.h>
+#endif
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#ifdef __APPLE__
+inline bool glLoadFunctions(){ return true; }
+#define GL_HAS(fn) true
+#else
+#define CLOCK2D_GL_FUNCTIONS(X) \
+    X(PFNGLACTIVETEXTUREPROC, glActiveTexture) \
+    X(PFNGLATTACHSHADERPROC, glAttachShader) \
+    X(PFNGLBEGINQUERYPROC, glBeginQuery) \
+    X(PFNGLBINDATTRIBLOCATIONPROC, glBindAttribLocation) \
+    X(PFNGLBINDBUFFERPROC, glBindBuffer) \
+    X(PFNGLBINDBUFFERBASEPROC, glBindBufferBase) \
+    X(PFNGLBINDBUFFERRANGEPROC, glBindBufferRange) \
+    X(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer) \
+    X(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer) \
+    X(PFNGLBINDTEXTUREPROC, glBindTexture) \
+    X(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray) \
+    X(PFNGLBLENDFUNCSEPARATEPROC, glBlendFuncSeparate) \
+    X(PFNGLBLITFRAMEBUFFERPROC, glBlitFramebuffer) \
+    X(PFNGLBUFFERDATAPROC, glBufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, glBufferSubData) \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus) \
+    X(PFNGLCLEARPROC, glClear) \
+    X(PFNGLCLEARCOLORPROC, glClearColor) \
+    X(PFNGLCLIENTWAITSYNCPROC, glClientWaitSync) \
+    X(PFNGLCOMPILESHADERPROC, glCompileShader) \
+    X(PFNGLCREATEPROGRAMPROC, glCreateProgram) \
+    X(PFNGLCREATESHADERPROC, glCreateShader) \
+    X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers) \
+    X(PFNGLDELETEPROGRAMPROC, glDeleteProgram) \
+    X(PFNGLDELETEQUERIESPROC, glDeleteQueries) \
+    X(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers) \
+    X(PFNGLDELETESHADERPROC, glDeleteShader) \
+    X(PFNGLDELETESYNCPROC, glDeleteSync) \
+    X(PFNGLDELETETEXTURESPROC, glDeleteTextures) \
+    X(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays) \
+    X(PFNGLDISABLEPROC, glDisable) \
+    X(PFNGLDRAWARRAYSPROC, glDrawArrays) \
+    X(PFNGLDRAWARRAYSINSTANCEDPROC, glDrawArraysInstanced) \
+    X(PFNGLENABLEPROC, glEnable) \
+    X(PFNGLENDQUERYPROC, glEndQuery) \
+    X(PFNGLFENCESYNCPROC, glFenceSync) \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer) \
+    X(PFNGLFRAMEBUFFERTEXTURE2DPROC, glFramebufferTexture2D) \
+    X(PFNGLGENBUFFERSPROC, glGenBuffers) \
+    X(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers) \
+    X(PFNGLGENQUERIESPROC, glGenQueries) \
+    X(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers) \
+    X(PFNGLGENTEXTURESPROC, glGenTextures) \
+    X(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays) \
+    X(PFNGLGETBUFFERPARAMETERIVPROC, glGetBufferParameteriv) \
+    X(PFNGLGETINTEGERVPROC, glGetIntegerv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog) \
+    X(PFNGLGETPROGRAMIVPROC, glGetProgramiv) \
+    X(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64v) \
+    X(PFNGLGETQUERYOBJECTUIVPROC, glGetQueryObjectuiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) \
+    X(PFNGLGETSHADERIVPROC, glGetShaderiv) \
+    X(PFNGLGETSTRINGPROC, glGetString) \
+    X(PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) \
+    X(PFNGLLINKPROGRAMPROC, glLinkProgram) \
+    X(PFNGLMAPBUFFERRANGEPROC, glMapBufferRange) \
+    X(PFNGLREADPIXELSPROC, glReadPixels) \
+    X(PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC, glRenderbufferStorageMultisample) \
+    X(PFNGLSCISSORPROC, glScissor) \
+    X(PFNGLSHADERSOURCEPROC, glShaderSource) \
+    X(PFNGLTEXBUFFERPROC, glTexBuffer) \
+    X(PFNGLTEXIMAGE2DPROC, glTexImage2D) \
+    X(PFNGLTEXPARAMETERIPROC, glTexParameteri) \
+    X(PFNGLUNIFORM1FPROC, glUniform1f) \
+    X(PFNGLUNIFORM1IPROC, glUniform1i) \
+    X(PFNGLUNIFORM2FPROC, glUniform2f) \
+    X(PFNGLUNIFORM3FVPROC, glUniform3fv) \
+    X(PFNGLUNIFORM4FPROC, glUniform4f) \
+    X(PFNGLUNIFORM4FVPROC, glUniform4fv) \
+    X(PFNGLUNIFORMBLOCKBINDINGPROC, glUniformBlockBinding) \
+    X(PFNGLUNMAPBUFFERPROC, glUnmapBuffer) \
+    X(PFNGLUSEPROGRAMPROC, glUseProgram) \
+    X(PFNGLVIEWPORTPROC, glViewport)
+
+// GL 4.1 / ARB_get_program_binary: null where the driver lacks it
+#define CLOCK2D_GL_OPTIONAL_FUNCTIONS(X) \
+    X(PFNGLGETPROGRAMBINARYPROC, glGetProgramBinary) \
+    X(PFNGLPROGRAMBINARYPROC, glProgramBinary) \
+    X(PFNGLPROGRAMPARAMETERIPROC, glProgramParameteri)
+
+// Pointers live in a namespace so they never collide with the symbols a
+// system libGL exports under the same names.
+namespace clock2d_gl {
+#define CLOCK2D_GL_DECLARE(type, name) extern type name;
+CLOCK2D_GL_FUNCTIONS(CLOCK2D_GL_DECLARE)
+CLOCK2D_GL_OPTIONAL_FUNCTIONS(CLOCK2D_GL_DECLARE)
+#undef CLOCK2D_GL_DECLARE
+}
+using namespace clock2d_gl;
+
+// Loads every entry point; false (after naming the first missing required
+// function) if the context is unusable. Call with a current context.
+bool glLoadFunctions();
+#define GL_HAS(fn) (fn != nullptr)
+#endif
@@ -0,0 +1,544 @@
+// src/glyph_atlas.cpp
+#include "glyph_atlas.h"
+#include "clock_geom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+// ================= Built-in block font =================
+// Digits are the dial's original box digits (genDigitMesh, 1.1 units tall)
+// at their original spacing; letters are square-capped strokes on a 4 x 6
+// grid, in the same stroke weight.
+static const float DIGIT_ADVANCE = 1.7f/1.1f;   // the old two-digit numerals' spacing
+static const float STROKE_HALF   = 0.09f;       // half stroke width
+static const float SIDE_BEARING  = 0.10f;
+
+// Collects a generator's triangles as counter-clockwise contours (their
+// union is the glyph, so they must all wind the same way).
+struct OutlineSink {
+    GlyphOutline& out;
+    float sx, sy, tx, ty;
+    std::vector<float> v;
+    uint16_t vert(float x, float y){
+        v.push_back(x*sx + tx); v.push_back(y*sy + ty);
+        return (uint16_t)(v.size()/2 - 1);
+    }
+    void tri(uint16_t a, uint16_t b, uint16_t c){
+        const float* p[3] = { &v[2*a], &v[2*b], &v[2*c] };
+        float area = (p[1][0]-p[0][0])*(p[2][1]-p[0][1]) - (p[1][1]-p[0][1])*(p[2][0]-p[0][0]);
+        if(area < 0.0f) std::swap(p[1], p[2]);
+        for(const float* q : p){ out.pts.push_back(q[0]); out.pts.push_back(q[1]); }
+        out.close();
+    }
+};
+
+// Polylines through grid points "xy", '|' between strokes; a lone point is a dot.
+static const struct { char c; const char* strokes; } STROKE_GLYPHS[] = {
+    { 'A', "00 05 16 36 45 40|03 43" }, { 'B', "00 06 36 45 44 33 03|33 42 41 30 00" },
+    { 'C', "46 06 00 40" },             { 'D', "00 06 36 45 41 30 00" },
+    { 'E', "46 06 00 40|03 33" },       { 'F', "46 06 00|03 33" },
+    { 'G', "46 06 00 40 43 23" },       { 'H', "00 06|40 46|03 43" },
+    { 'I', "00 06" },                   { 'J', "46 40 00 02" },
+    { 'K', "00 06|46 03 40" },          { 'L', "06 00 40" },
+    { 'M', "00 06 23 46 40" },          { 'N', "00 06 40 46" },
+    { 'O', "00 06 46 40 00" },          { 'P', "00 06 46 43 03" },
+    { 'Q', "00 06 46 40 00|22 40" },    { 'R', "00 06 46 43 03 40" },
+    { 'S', "46 06 03 43 40 00" },       { 'T', "06 46|20 26" },
+    { 'U', "06 00 40 46" },             { 'V', "06 20 46" },
+    { 'W', "06 10 23 30 46" },          { 'X', "06 40|00 46" },
+    { 'Y', "06 23 46|23 20" },          { 'Z', "06 46 00 40" },
+    { '-', "03 23" },                   { '.', "00" },
+    { ':', "02|04" },                   { '/', "00 26" },
+};
+
+// One segment as a quad, square caps reaching STROKE_HALF past both ends.
+static void addStroke(GlyphOutline& o, float x0, float y0, float x1, float y1){
+    float dx = x1 - x0, dy = y1 - y0, len = std::sqrt(dx*dx + dy*dy);
+    if(len > 0.0f){ dx /= len; dy /= len; } else { dx = 1.0f; dy = 0.0f; }
+    const float h = STROKE_HALF;
+    const float ax = x0 - dx*h, ay = y0 - dy*h, bx = x1 + dx*h, by = y1 + dy*h;
+    const float nx = -dy*h, ny = dx*h;
+    const float q[8] = { ax - nx, ay - ny,  bx - nx, by - ny,  bx + nx, by + ny,  ax + nx, ay + ny };
+    o.pts.insert(o.pts.end(), q, q + 8);
+    o.close();
+}
+
+static bool builtinOutline(uint32_t cp, GlyphOutline& o){
+    o = GlyphOutline{};
+    if(cp >= '0' && cp <= '9'){
+        o.advance = DIGIT_ADVANCE;
+        OutlineSink sink{ o, 1.0f/1.1f, 1.0f/1.1f, 0.5f*DIGIT_ADVANCE, 0.5f, {} };
+        genDigitMesh(sink, (int)(cp - '0'));
+        return true;
+    }
+    if(cp == ' '){ o.advance = 0.5f; return true; }
+    for(const auto& g : STROKE_GLYPHS){
+        if((uint32_t)(unsigned char)g.c != cp) continue;
+        const float unit = (1.0f - 2.0f*STROKE_HALF)/6.0f;
+        int maxX = 0;
+        for(const char* p = g.strokes; *p; p++) if(p[0] >= '0' && p[0] <= '9' && (p == g.strokes || p[-1] == ' ' || p[-1] == '|'))
+            maxX = std::max(maxX, p[0] - '0');
+        auto px = [&](char c){ return SIDE_BEARING + STROKE_HALF + (c - '0')*unit; };
+        auto py = [&](char c){ return STROKE_HALF + (c - '0')*unit; };
+        for(const char* s = g.strokes; *s; ){
+            const char* e = std::strchr(s, '|');
+            if(!e) e = s + std::strlen(s);
+            if(e - s == 2) addStroke(o, px(s[0]), py(s[1]), px(s[0]), py(s[1])); // dot
+            for(const char* p = s; p + 5 <= e; p += 3)
+                addStroke(o, px(p[0]), py(p[1]), px(p[3]), py(p[4]));
+            s = *e ? e + 1 : e;
+        }
+        o.advance = 2.0f*(SIDE_BEARING + STROKE_HALF) + maxX*unit;
+        return true;
+    }
+    return false;
+}
+
+// ================= TrueType =================
+// Just enough of the format for outlines: cmap (formats 4 and 12), head,
+// maxp, hhea/hmtx, loca/glyf with simple and composite glyphs, and OS/2's
+// cap height. Every read is bounds-checked and every glyph's expansion is
+// capped (Font::MAX_GLYPH_*); a damaged file yields garbage shapes or
+// missing glyphs, never a crash or a hang.
+namespace {
+struct Reader {
+    const std::vector<uint8_t>& d;
+    uint32_t u8 (uint32_t o) const { return o < d.size() ? d[o] : 0; }
+    uint32_t u16(uint32_t o) const { return u8(o) << 8 | u8(o + 1); }
+    int32_t  i16(uint32_t o) const { return (int16_t)u16(o); }
+    uint32_t u32(uint32_t o) const { return u16(o) << 16 | u16(o + 2); }
+};
+}
+
+bool Font::loadTrueType(const char* path){
+    FILE* f = std::fopen(path, "rb");
+    if(!f){ std::fprintf(stderr, "[Font] cannot open %s\n", path); return false; }
+    std::vector<uint8_t> bytes;
+    uint8_t buf[65536];
+    for(size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0; ) bytes.insert(bytes.end(), buf, buf + n);
+    std::fclose(f);
+
+    const Reader r{ bytes };
+    uint32_t base = 0;
+    if(r.u32(0) == 0x74746366u) base = r.u32(12); // 'ttcf': first font of the collection
+    const uint32_t version = r.u32(base);
+    if(version == 0x4F54544Fu){ std::fprintf(stderr, "[Font] %s: CFF outlines are not supported\n", path); return false; }
+    if(version != 0x00010000u && version != 0x74727565u){ std::fprintf(stderr, "[Font] %s: not a TrueType font\n", path); return false; }
+
+    uint32_t head=0, maxp=0, hhea=0, os2=0, glyfLen=0;
+    const uint32_t numTables = r.u16(base + 4);
+    for(uint32_t i=0; i<numTables; i++){
+        const uint32_t rec = base + 12 + 16*i, tag = r.u32(rec), off = r.u32(rec + 8);
+        switch(tag){
+            case 0x636D6170u: cmap = off; break;                          // cmap
+            case 0x68656164u: head = off; break;                          // head
+            case 0x6C6F6361u: loca = off; break;                          // loca
+            case 0x676C7966u: glyf = off; glyfLen = r.u32(rec + 12); break; // glyf
+            case 0x68686561u: hhea = off; break;                          // hhea
+            case 0x686D7478u: hmtx = off; break;                          // hmtx
+            case 0x6D617870u: maxp = off; break;                          // maxp
+            case 0x4F532F32u: os2  = off; break;                          // OS/2
+        }
+    }
+    if(!cmap || !head || !loca || !glyf || !hhea || !hmtx || !maxp){
+        std::fprintf(stderr, "[Font] %s: missing required tables\n", path);
+        return false;
+    }
+    glyfEnd     = glyf + glyfLen;
+    locFormat   = r.i16(head + 50);
+    numGlyphs   = (int)r.u16(maxp + 4);
+    numHMetrics = (int)r.u16(hhea + 34);
+
+    // Unicode subtable: full repertoire (format 12) first, else the BMP (format 4)
+    uint32_t best = 0;
+    for(uint32_t i=0, n=r.u16(cmap + 2); i<n; i++){
+        const uint32_t rec = cmap + 4 + 8*i, plat = r.u16(rec), enc = r.u16(rec + 2);
+        const uint32_t sub = cmap + r.u32(rec + 4), fmt = r.u16(sub);
+        const bool unicode = plat == 0 || (plat == 3 && (enc == 1 || enc == 10));
+        if(!unicode || (fmt != 4 && fmt != 12)) continue;
+        if(!best || fmt == 12){ best = sub; cmapFormat = (int)fmt; }
+    }
+    if(!best){ std::fprintf(stderr, "[Font] %s: no Unicode cmap\n", path); return false; }
+    cmap = best;
+    const uint32_t unitsPerEm = r.u16(head + 18);
+    capHeight = 0.0f;
+    if(os2 && r.u16(os2) >= 2) capHeight = (float)r.i16(os2 + 88);
+    data.swap(bytes);
+
+    // Cap height: OS/2 v2+, else the top of 'H', else 70% of the em
+    if(capHeight <= 0.0f){
+        GlyphOutline h;
+        const float unit[6] = { 1, 0, 0, 1, 0, 0 };
+        int components = 0;
+        if(glyphOutline(glyphIndex('H'), unit, h, 0, components))
+            for(size_t i=1; i<h.pts.size(); i+=2) capHeight = std::max(capHeight, h.pts[i]);
+    }
+    if(capHeight <= 0.0f) capHeight = 0.7f*(float)unitsPerEm;
+    if(capHeight <= 0.0f){ data.clear(); std::fprintf(stderr, "[Font] %s: no usable metrics\n", path); return false; }
+    return true;
+}
+
+int Font::glyphIndex(uint32_t cp) const {
+    const Reader r{ data };
+    if(cmapFormat == 12){
+        for(uint32_t i=0, n=r.u32(cmap + 12); i<n && i<(1u<<20); i++){
+            const uint32_t g = cmap + 16 + 12*i;
+            if(cp >= r.u32(g) && cp <= r.u32(g + 4)) return (int)(r.u32(g + 8) + cp - r.u32(g));
+        }
+        return 0;
+    }
+    if(cp > 0xFFFF) return 0;
+    const uint32_t segX2 = r.u16(cmap + 6);
+    const uint32_t ends = cmap + 14, starts = ends + segX2 + 2, deltas = starts + segX2, ranges = deltas + segX2;
+    for(uint32_t s=0; s<segX2; s+=2){
+        if(cp > r.u16(ends + s)) continue;
+        const uint32_t start = r.u16(starts + s);
+        if(cp < start) return 0;
+        const uint32_t delta = r.u16(deltas + s), ro = r.u16(ranges + s);
+        if(!ro) return (int)((cp + delta) & 0xFFFF);
+        const uint32_t g = r.u16(ranges + s + ro + 2*(cp - start));
+        return g ? (int)((g + delta) & 0xFFFF) : 0;
+    }
+    return 0;
+}
+
+// xf maps font units to the output: x' = xf0*x + xf2*y + xf4, y' = xf1*x + xf3*y + xf5.
+bool Font::glyphOutline(int gid, const float xf[6], GlyphOutline& out, int depth, int& components) const {
+    const Reader r{ data };
+    if(gid < 0 || gid >= numGlyphs || depth > 4) return false;
+    const uint32_t off = locFormat ? r.u32(loca + 4*gid)   : 2*r.u16(loca + 2*gid);
+    const uint32_t end = locFormat ? r.u32(loca + 4*gid+4) : 2*r.u16(loca + 2*gid+2);
+    if(end <= off) return true;                     // no contours (space)
+    const uint32_t o = glyf + off, glyphEnd = glyf + end;
+    if(glyphEnd > glyfEnd) return false;
+    const int contours = r.i16(o);
+
+    if(contours < 0){                               // composite: transformed components
+        uint32_t p = o + 10;
+        for(uint32_t flags = 0x20; (flags & 0x20) && p < glyphEnd; ){
+            flags = r.u16(p);
+            const int child = (int)r.u16(p + 2);
+            p += 4;
+            float dx, dy;
+            if(flags & 1){ dx = (float)r.i16(p); dy = (float)r.i16(p + 2); p += 4; }
+            else         { dx = (float)(int8_t)r.u8(p); dy = (float)(int8_t)r.u8(p + 1); p += 2; }
+            if(!(flags & 2)) dx = dy = 0.0f;        // point matching: not supported, placed at the origin
+            float a = 1, b = 0, c = 0, d = 1;
+            auto f2dot14 = [&](uint32_t q){ return (float)r.i16(q)/16384.0f; };
+            if(flags & 0x08)     { a = d = f2dot14(p); p += 2; }
+            else if(flags & 0x40){ a = f2dot14(p); d = f2dot14(p + 2); p += 4; }
+            else if(flags & 0x80){ a = f2dot14(p); b = f2dot14(p + 2); c = f2dot14(p + 4); d = f2dot14(p + 6); p += 8; }
+            const float m[6] = {
+                xf[0]*a + xf[2]*b,  xf[1]*a + xf[3]*b,
+                xf[0]*c + xf[2]*d,  xf[1]*c + xf[3]*d,
+                xf[0]*dx + xf[2]*dy + xf[4],  xf[1]*dx + xf[3]*dy + xf[5] };
+            if(++components > MAX_GLYPH_COMPONENTS) return false;
+            if(!glyphOutline(child, m, out, depth + 1, components)) return false;
+        }
+        return true;
+    }
+
+    // Simple glyph: end points, instructions, flags (run-length), x deltas, y deltas
+    const uint32_t numPts = contours ? r.u16(o + 10 + 2*(contours - 1)) + 1 : 0;
+    uint32_t p = o + 10 + 2*contours;
+    p += 2 + r.u16(p);
+    std::vector<uint8_t> flags(numPts);
+    for(uint32_t i=0; i<numPts; ){
+        const uint8_t f = (uint8_t)r.u8(p++);
+        flags[i++] = f;
+        if(f & 8) for(uint32_t n = r.u8(p++); n-- && i<numPts; ) flags[i++] = f;
+    }
+    std::vector<float> x(numPts), y(numPts);
+    for(int axis=0; axis<2; axis++){
+        const uint8_t shortBit = axis ? 4 : 2, sameBit = axis ? 32 : 16;
+        float v = 0.0f;
+        for(uint32_t i=0; i<numPts; i++){
+            const uint8_t f = flags[i];
+            if(f & shortBit){ v += (f & sameBit) ? (float)r.u8(p) : -(float)r.u8(p); p += 1; }
+            else if(!(f & sameBit)){ v += (float)r.i16(p); p += 2; }
+            (axis ? y : x)[i] = v;
+        }
+    }
+
+    // Contours: implied on-curve points between off-curve pairs, quadratics flattened
+    auto emit = [&](float px, float py){
+        out.pts.push_back(xf[0]*px + xf[2]*py + xf[4]);
+        out.pts.push_back(xf[1]*px + xf[3]*py + xf[5]);
+    };
+    const int QUAD_STEPS = 8;
+    uint32_t first = 0;
+    for(int c=0; c<contours; c++){
+        const uint32_t last = r.u16(o + 10 + 2*c);
+        if(last < first || last >= numPts){ first = last + 1; continue; }
+        struct P { float x, y; bool on; };
+        std::vector<P> pts;
+        for(uint32_t i=first; i<=last; i++){
+            const P cur{ x[i], y[i], (flags[i] & 1) != 0 };
+            if(!pts.empty() && !cur.on && !pts.back().on)
+                pts.push_back(P{ 0.5f*(cur.x + pts.back().x), 0.5f*(cur.y + pts.back().y), true });
+            pts.push_back(cur);
+        }
+        first = last + 1;
+        if(pts.size() < 2) continue;
+        if(!pts.front().on && !pts.back().on)
+            pts.push_back(P{ 0.5f*(pts.front().x + pts.back().x), 0.5f*(pts.front().y + pts.back().y), true });
+        while(!pts.front().on) std::rotate(pts.begin(), pts.begin() + 1, pts.end());
+        const size_t n = pts.size();
+        if(out.pts.size()/2 + QUAD_STEPS*n > (size_t)MAX_GLYPH_POINTS) return false;
+        emit(pts[0].x, pts[0].y);
+        for(size_t i=1; i<=n; i++){
+            const P& q = pts[i % n];
+            if(q.on){ if(i < n) emit(q.x, q.y); continue; }
+            const P& a = pts[i - 1], &b = pts[(i + 1) % n];
+            for(int s=1; s<=QUAD_STEPS; s++){
+                const float t = (float)s/QUAD_STEPS, u = 1.0f - t;
+                if(s == QUAD_STEPS && (i + 1) % n == 0) break; // back at the start point
+                emit(u*u*a.x + 2*u*t*q.x + t*t*b.x, u*u*a.y + 2*u*t*q.y + t*t*b.y);
+            }
+            i++;
+        }
+        out.close();
+    }
+    return true;
+}
+
+bool Font::outline(uint32_t cp, GlyphOutline& out) const {
+    if(data.empty()) return builtinOutline(cp, out);
+    out = GlyphOutline{};
+    const int gid = glyphIndex(cp);
+    if(gid == 0 && cp != ' ') return false;
+    const float s = 1.0f/capHeight;
+    const float xf[6] = { s, 0, 0, s, 0, 0 };
+    int components = 0;
+    if(!glyphOutline(gid, xf, out, 0, components)) return false;
+    const Reader r{ data };
+    const int m = std::min(gid, numHMetrics - 1);
+    out.advance = (float)r.u16(hmtx + 4*(uint32_t)std::max(m, 0))*s;
+    return true;
+}
+
+static uint64_t fnv1a(uint64_t h, const void* p, size_t n){
+    for(size_t i=0; i<n; i++){ h ^= ((const unsigned char*)p)[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+uint64_t Font::hash() const {
+    static const char BUILTIN[] = "clock2d builtin block font 1";
+    const uint64_t h = 14695981039346656037ull;
+    return data.empty() ? fnv1a(h, BUILTIN, sizeof(BUILTIN)) : fnv1a(h, data.data(), data.size());
+}
+
+// ================= Distance field =================
+// Each glyph is rasterized SS x SS per texel with the nonzero rule, the
+// exact Euclidean distance transform (Felzenszwalb-Huttenlocher) of that
+// mask and of its complement gives the signed distance, and each texel
+// keeps the mean of its central samples. Works for any outline, including
+// overlapping parts (the box digits) and holes.
+static const int SS = 4;
+
+static void edt1d(const double* f, int n, double* d, int* v, double* z){
+    int k = 0;
+    v[0] = 0; z[0] = -std::numeric_limits<double>::infinity(); z[1] = -z[0];
+    for(int q=1; q<n; q++){
+        double s;
+        for(;;){
+            const int p = v[k];
+            s = ((f[q] + (double)q*q) - (f[p] + (double)p*p))/(2.0*(q - p));
+            if(s > z[k]) break;
+            k--;
+        }
+        k++; v[k] = q; z[k] = s; z[k+1] = std::numeric_limits<double>::infinity();
+    }
+    k = 0;
+    for(int q=0; q<n; q++){
+        while(z[k+1] < q) k++;
+        d[q] = (double)(q - v[k])*(q - v[k]) + f[v[k]];
+    }
+}
+
+// Squared distance from every pixel to the nearest pixel where `seed` holds.
+static void edt2d(const std::vector<uint8_t>& mask, bool seed, int n, std::vector<double>& out){
+    const double FAR = 1e20;
+    std::vector<double> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+    out.resize((size_t)n*n);
+    for(size_t i=0; i<out.size(); i++) out[i] = (mask[i] != 0) == seed ? 0.0 : FAR;
+    for(int x=0; x<n; x++){
+        for(int y=0; y<n; y++) f[y] = out[(size_t)y*n + x];
+        edt1d(f.data(), n, d.data(), v.data(), z.data());
+        for(int y=0; y<n; y++) out[(size_t)y*n + x] = d[y];
+    }
+    for(int y=0; y<n; y++){
+        edt1d(&out[(size_t)y*n], n, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.end(), out.begin() + (size_t)y*n);
+    }
+}
+
+static void renderCell(const GlyphOutline& g, uint8_t* dst, int stride){
+    const int N = GlyphAtlas::CELL*SS;
+    const float px = GlyphAtlas::CELL_CAPS/N;
+    const float ox = 0.5f*g.advance - 0.5f*GlyphAtlas::CELL_CAPS, oy = 0.5f - 0.5f*GlyphAtlas::CELL_CAPS;
+
+    // Scanline fill, nonzero winding
+    std::vector<uint8_t> mask((size_t)N*N, 0);
+    std::vector<std::pair<float, int>> xs;
+    for(int j=0; j<N; j++){
+        const float y = oy + (j + 0.5f)*px;
+        xs.clear();
+        int start = 0;
+        for(int end : g.contourEnds){
+            for(int i=start; i<end; i++){
+                const int k = i + 1 < end ? i + 1 : start;
+                const float x0 = g.pts[2*i], y0 = g.pts[2*i+1], x1 = g.pts[2*k], y1 = g.pts[2*k+1];
+                if((y0 <= y) == (y1 <= y)) continue;
+                xs.push_back({ x0 + (y - y0)*(x1 - x0)/(y1 - y0), y1 > y0 ? 1 : -1 });
+            }
+            start = end;
+        }
+        std::sort(xs.begin(), xs.end());
+        int winding = 0;
+        for(size_t s=0; s+1<xs.size(); s++){
+            winding += xs[s].second;
+            if(!winding) continue;
+            const int i0 = std::max(0, (int)std::ceil((xs[s].first - ox)/px - 0.5f));
+            const int i1 = std::min(N, (int)std::ceil((xs[s+1].first - ox)/px - 0.5f));
+            for(int i=i0; i<i1; i++) mask[(size_t)j*N + i] = 1;
+        }
+    }
+
+    std::vector<double> toInside, toOutside;
+    edt2d(mask, true, N, toInside);
+    edt2d(mask, false, N, toOutside);
+    auto sd = [&](int i, int j){ // pixels, negative inside
+        const size_t k = (size_t)j*N + i;
+        return mask[k] ? -(std::sqrt(toOutside[k]) - 0.5) : std::sqrt(toInside[k]) - 0.5;
+    };
+    for(int ty=0; ty<GlyphAtlas::CELL; ty++){
+        for(int tx=0; tx<GlyphAtlas::CELL; tx++){
+            const int i = tx*SS + SS/2 - 1, j = ty*SS + SS/2 - 1;
+            const double d = 0.25*(sd(i, j) + sd(i+1, j) + sd(i, j+1) + sd(i+1, j+1))*px;
+            const double v = std::min(1.0, std::max(0.0, 0.5 - d/(2.0*GlyphAtlas::SPREAD)));
+            dst[(size_t)ty*stride + tx] = (uint8_t)std::lround(v*255.0);
+        }
+    }
+}
+
+// ================= Atlas =================
+uint64_t GlyphAtlas::key(const Font& f, const std::vector<uint32_t>& cps){
+    const float params[3] = { (float)CELL, CELL_CAPS, SPREAD };
+    uint64_t h = fnv1a(f.hash(), params, sizeof(params));
+    return fnv1a(h, cps.data(), cps.size()*sizeof(uint32_t));
+}
+
+void GlyphAtlas::build(const Font& f, const std::vector<uint32_t>& cps){
+    codepoints.clear();
+    advances.clear();
+    std::vector<GlyphOutline> outlines;
+    int missing = 0;
+    uint32_t firstMissing = 0;
+    for(uint32_t cp : cps){
+        GlyphOutline g;
+        if(!f.outline(cp, g)){ if(!missing++) firstMissing = cp; continue; }
+        codepoints.push_back(cp);
+        advances.push_back(g.advance);
+        outlines.push_back(std::move(g));
+    }
+    if(missing)
+        std::fprintf(stderr, "[GlyphAtlas] %d codepoint%s not in the font (first U+%04X)\n",
+                     missing, missing == 1 ? "" : "s", (unsigned)firstMissing);
+    rows   = std::max(1, ((int)outlines.size() + COLS - 1)/COLS);
+    width  = COLS*CELL;
+    height = rows*CELL;
+    texels.assign((size_t)width*height, 0);
+    for(size_t i=0; i<outlines.size(); i++)
+        renderCell(outlines[i], &texels[(i/COLS)*CELL*(size_t)width + (i%COLS)*CELL], width);
+}
+
+int GlyphAtlas::find(uint32_t cp) const {
+    auto it = std::lower_bound(codepoints.begin(), codepoints.end(), cp);
+    return it != codepoints.end() && *it == cp ? (int)(it - codepoints.begin()) : -1;
+}
+
+// File: magic, key, cell count, rows; codepoints, advances; texels.
+struct AtlasFileHeader {
+    char     magic[8];   // "C2DATLS1"
+    uint64_t key;
+    uint32_t count, rows, cell, cols;
+};
+static const char ATLAS_MAGIC[8] = {'C','2','D','A','T','L','S','1'};
+
+bool GlyphAtlas::load(const char* path, uint64_t k){
+    FILE* f = std::fopen(path, "rb");
+    if(!f) return false;
+    AtlasFileHeader hdr;
+    bool ok = std::fread(&hdr, sizeof(hdr), 1, f) == 1
+           && !std::memcmp(hdr.magic, ATLAS_MAGIC, sizeof(hdr.magic)) && hdr.key == k
+           && hdr.cell == (uint32_t)CELL && hdr.cols == (uint32_t)COLS
+           && hdr.count <= hdr.rows*(uint32_t)COLS && hdr.rows > 0 && hdr.rows < 4096;
+    if(ok){
+        codepoints.resize(hdr.count);
+        advances.resize(hdr.count);
+        rows = (int)hdr.rows; width = COLS*CELL; height = rows*CELL;
+        texels.resize((size_t)width*height);
+        ok = std::fread(codepoints.data(), sizeof(uint32_t), hdr.count, f) == hdr.count
+          && std::fread(advances.data(), sizeof(float), hdr.count, f) == hdr.count
+          && std::fread(texels.data(), 1, texels.size(), f) == texels.size()
+          && std::is_sorted(codepoints.begin(), codepoints.end());
+    }
+    std::fclose(f);
+    if(!ok){ codepoints.clear(); advances.clear(); texels.clear(); width = height = rows = 0; }
+    return ok;
+}
+
+// Write-then-rename, like the program binary cache.
+bool GlyphAtlas::save(const char* path, uint64_t k) const {
+    AtlasFileHeader hdr;
+    std::memcpy(hdr.magic, ATLAS_MAGIC, sizeof(hdr.magic));
+    hdr.key = k; hdr.count = (uint32_t)codepoints.size(); hdr.rows = (uint32_t)rows;
+    hdr.cell = CELL; hdr.cols = COLS;
+    char tmp[1100]; std::snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = std::fopen(tmp, "wb");
+    if(!f){ std::fprintf(stderr, "[GlyphAtlas] cannot write %s\n", tmp); return false; }
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1
+           && std::fwrite(codepoints.data(), sizeof(uint32_t), codepoints.size(), f) == codepoints.size()
+           && std::fwrite(advances.data(), sizeof(float), advances.size(), f) == advances.size()
+           && std::fwrite(texels.data(), 1, texels.size(), f) == texels.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok || std::rename(tmp, path) != 0){ std::remove(tmp); return false; }
+    return true;
+}
+
+// ================= Text =================
+uint32_t decodeUtf8(const char*& p){
+    const unsigned char c = (unsigned char)*p++;
+    if(c < 0x80) return c;
+    int n = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+    if(n < 0 || c >= 0xF8) return 0xFFFD;
+    uint32_t cp = c & (0x3F >> n);
+    for(; n > 0; n--){
+        if(((unsigned char)*p & 0xC0) != 0x80) return 0xFFFD; // truncated: leave the byte for the next call
+        cp = cp << 6 | ((unsigned char)*p++ & 0x3F);
+    }
+    return cp;
+}
+
+void addCodepoints(std::vector<uint32_t>& cps, const char* utf8){
+    for(const char* p = utf8; *p; ) cps.push_back(decodeUtf8(p));
+    std::sort(cps.begin(), cps.end());
+    cps.erase(std::unique(cps.begin(), cps.end()), cps.end());
+}
+
+float layoutText(const GlyphAtlas& atlas, const char* utf8, std::vector<PlacedGlyph>& out){
+    float pen = 0.0f;
+    for(const char* p = utf8; *p; ){
+        const int cell = atlas.find(decodeUtf8(p));
+        if(cell < 0) continue;
+        const float adv = atlas.advances[cell];
+        out.push_back(PlacedGlyph{ cell, pen + 0.5f*adv, 0.5f });
+        pen += adv;
+    }
+    return pen;
+}
@@ -0,0 +1,72 @@
+// src/glyph_atlas.h
+// Text for the dial: glyph outlines from a font, rendered once into a
+// single-channel signed-distance atlas, laid out as one quad per glyph.
+// Fonts are either the built-in block font (the digit boxes the dial
+// always used, plus stroke capitals A-Z and a little punctuation) or a
+// TrueType file (glyf outlines; CFF-flavoured OpenType is not read).
+// Outlines are in cap units: baseline at y=0, cap height at y=1, so any two
+// fonts set at the same size line up. GL-free; main.cpp uploads `texels`.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Closed polygons, filled with the nonzero rule.
+struct GlyphOutline {
+    std::vector<float> pts;         // xy pairs
+    std::vector<int>   contourEnds; // one past each contour's last point
+    float advance=0.0f;             // pen advance
+    void close(){ contourEnds.push_back((int)pts.size()/2); }
+};
+
+struct Font {
+    // Per glyph, composites included; a glyph over either fails to load
+    static const int MAX_GLYPH_POINTS = 65536;    // emitted outline points
+    static const int MAX_GLYPH_COMPONENTS = 256;  // composite references
+
+    std::vector<uint8_t> data;      // TrueType file; empty = built-in block font
+    uint32_t cmap=0, loca=0, glyf=0, hmtx=0, glyfEnd=0;
+    int  cmapFormat=0, locFormat=0, numGlyphs=0, numHMetrics=0;
+    float capHeight=1.0f;           // font units per cap unit
+
+    bool loadTrueType(const char* path);
+    // False for a codepoint the font has no glyph for.
+    bool outline(uint32_t cp, GlyphOutline& out) const;
+    uint64_t hash() const;
+
+    // ---- TrueType internals ----
+    int  glyphIndex(uint32_t cp) const;
+    // components: references followed so far for this glyph
+    bool glyphOutline(int gid, const float xf[6], GlyphOutline& out, int depth, int& components) const;
+};
+
+struct GlyphAtlas {
+    static const int   CELL = 48;          // texels per cell side
+    static const int   COLS = 16;          // cells per atlas row
+    static constexpr float CELL_CAPS = 2.0f; // cell side in cap units
+    static constexpr float SPREAD = 0.15f;   // distance range either side of the edge, cap units
+
+    int width=0, height=0, rows=0;
+    std::vector<uint8_t>  texels;      // R8, bottom row first; 0.5 = edge, higher = inside
+    std::vector<uint32_t> codepoints;  // cell i holds codepoints[i], sorted
+    std::vector<float>    advances;
+
+    // Cell i covers x in [advance/2 - 1, advance/2 + 1], y in [-0.5, 1.5]:
+    // a glyph quad is centered half an advance past the pen, half a cap up.
+    static uint64_t key(const Font& f, const std::vector<uint32_t>& cps);
+    void build(const Font& f, const std::vector<uint32_t>& cps);
+    bool load(const char* path, uint64_t key);
+    bool save(const char* path, uint64_t key) const;
+    int  find(uint32_t cp) const;      // cell, or -1
+};
+
+// Decodes one UTF-8 sequence and advances p; malformed bytes read as U+FFFD.
+uint32_t decodeUtf8(const char*& p);
+// Sorted, unique codepoints of a UTF-8 string, appended to cps.
+void addCodepoints(std::vector<uint32_t>& cps, const char* utf8);
+
+// One laid-out glyph: atlas cell and the cell center, in cap units from
+// the start of the line's baseline.
+struct PlacedGlyph { int cell; float x, y; };
+// Returns the line's advance width; glyphs the atlas lacks are skipped.
+float layoutText(const GlyphAtlas& atlas, const char* utf8, std::vector<PlacedGlyph>& out);
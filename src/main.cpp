@@ -1,36 +1,118 @@
 // src/main.cpp
-#ifndef GL_SILENCE_DEPRECATION
-#define GL_SILENCE_DEPRECATION
-#endif
-#include <OpenGL/gl3.h>
-#include <GLFW/glfw3.h>
+#include "gl_platform.h"
+#include "clock_geom.h"
+#include "render_backend.h"
+#include "frame_encode.h"
+#include "soft_raster.h"
+#include "present.h"
+#include "glyph_atlas.h"
+#include "time_sync.h"
+#include "complications.h"
 
 #include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <new>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <malloc.h>
+#endif
 
 // ================= Shaders (GLSL 1.50 core) =================
+// Batched draw: one instance per CHUNK_VERTS-index slice of a record's mesh.
+// Indices and vertices are pulled from the geometry arena (TBOs), the chunk
+// table says which slice/record an instance is, and the record (transform + color)
+// comes from the Records uniform block. Vertices past the end of a short
+// chunk collapse to a point, so their triangles rasterize nothing. A record
+// naming an atlas cell is a glyph: its unit quad samples the distance field
+// and blends in by coverage, so text needs no draw call of its own.
 static const char* VS_SRC = R"GLSL(
 #version 150 core
-in vec2 aPos;
-uniform float uAngle;   // radians, clockwise positive
-uniform vec2  uScale;   // NDC scale
-uniform vec2  uTrans;   // NDC translate
+struct Record {
+    vec4 m;      // column-major mat2: rotation and NDC scale, built on the CPU
+    vec4 tr;     // xy: NDC translate, z: glyph atlas cell + 1 (0: solid mesh)
+    vec4 color;
+};
+layout(std140) uniform Records { Record uRec[256]; };
+layout(std140) uniform Clocks  { vec4 uClock[65]; }; // per dial: xy NDC scale, zw NDC translate; last: screen
+uniform samplerBuffer  uVerts;   // arena VBO viewed as RG32F
+uniform usamplerBuffer uIndices; // arena element buffer viewed as R16UI
+uniform isamplerBuffer uChunks;  // (first index, index count, record, base vertex)
+uniform int uChunkBase;          // first chunk of the layer being drawn
+uniform int uChunkCount;         // chunks in that layer; instances = chunks x dials
+uniform int uRecordStride;       // records between dials (0: shared by every dial)
+uniform int uClockBase;          // placement of the first dial
+flat out vec3 vColor;
+flat out float vGlyph;
+out vec2 vUV;                    // glyphs: position in the atlas cell
 void main(){
-    float c = cos(uAngle), s = sin(uAngle);
-    vec2 p = vec2(c*aPos.x - s*aPos.y, s*aPos.x + c*aPos.y);
-    p = p*uScale + uTrans;
-    gl_Position = vec4(p, 0.0, 1.0);
+    int   k = gl_InstanceID / uChunkCount; // dial
+    ivec4 c = texelFetch(uChunks, uChunkBase + gl_InstanceID - k*uChunkCount);
+    vColor = vec3(0.0); vGlyph = 0.0; vUV = vec2(0.0);
+    if(gl_VertexID >= c.y){ gl_Position = vec4(0.0, 0.0, 0.0, 1.0); return; }
+    Record r = uRec[c.z + k*uRecordStride];
+    int  i = int(texelFetch(uIndices, c.x + gl_VertexID).r);
+    vec2 a = texelFetch(uVerts, c.w + i).xy;
+    vec2 p = mat2(r.m.xy, r.m.zw)*a + r.tr.xy;
+    vec4 g = uClock[uClockBase + k];
+    gl_Position = vec4(p*g.xy + g.zw, 0.0, 1.0);
+    vColor = r.color.rgb;
+    vGlyph = r.tr.z;
+    vUV    = a + 0.5;
 }
 )GLSL";
 
 static const char* FS_SRC = R"GLSL(
 #version 150 core
+flat in vec3 vColor;
+flat in float vGlyph;
+in vec2 vUV;
+uniform sampler2D uAtlas;  // GlyphAtlas distance fields, 0.5 = edge
+uniform vec2 uAtlasCells;  // columns, rows
+out vec4 FragColor;
+void main(){
+    float a = 1.0;
+    if(vGlyph > 0.5){
+        float cell = vGlyph - 1.0;
+        vec2 uv = (vec2(mod(cell, uAtlasCells.x), floor(cell/uAtlasCells.x)) + vUV)/uAtlasCells;
+        float d = texture(uAtlas, uv).r - 0.5;
+        a = clamp(d/max(fwidth(d), 1e-4) + 0.5, 0.0, 1.0);
+    }
+    FragColor = vec4(vColor, a);
+}
+)GLSL";
+
+// Composite: fullscreen triangle from gl_VertexID, 1:1 texel fetch of the dial layer
+static const char* COMPOSITE_VS_SRC = R"GLSL(
+#version 150 core
+void main(){
+    vec2 p = vec2((gl_VertexID<<1)&2, gl_VertexID&2);
+    gl_Position = vec4(p*2.0 - 1.0, 0.0, 1.0);
+}
+)GLSL";
+
+static const char* COMPOSITE_FS_SRC = R"GLSL(
+#version 150 core
 out vec4 FragColor;
-uniform vec3 uColor;
-void main(){ FragColor = vec4(uColor, 1.0); }
+uniform sampler2D uDial;
+void main(){ FragColor = texelFetch(uDial, ivec2(gl_FragCoord.xy), 0); }
 )GLSL";
 
 // ================= GL helpers =================
@@ -47,13 +129,14 @@ static GLuint makeShader(GLenum type, const char* src){
     }
     return sh;
 }
-static GLuint makeProgram(const char* vs, const char* fs){
+static GLuint compileProgram(const char* vs, const char* fs, bool retrievable){
     GLuint v = makeShader(GL_VERTEX_SHADER, vs);
     GLuint f = makeShader(GL_FRAGMENT_SHADER, fs);
     GLuint p = glCreateProgram();
     glAttachShader(p, v);
     glAttachShader(p, f);
     glBindAttribLocation(p, 0, "aPos"); // GLSL 150 core: bind before link
+    if(retrievable) glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(p);
     glDeleteShader(v);
     glDeleteShader(f);
@@ -67,346 +150,2659 @@ static GLuint makeProgram(const char* vs, const char* fs){
     return p;
 }
 
-// ================= Mesh wrapper (Triangles) =================
-struct Mesh {
-    GLuint vao=0, vbo=0;
-    GLsizei count=0;
-    void init(const std::vector<float>& verts){
-        count = (GLsizei)(verts.size()/2);
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-        glGenBuffers(1, &vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, verts.size()*sizeof(float), verts.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
-        glBindVertexArray(0);
+// ================= Program binary cache =================
+// Linked programs are saved with glGetProgramBinary and restored with
+// glProgramBinary on the next launch, skipping compile and link. Each
+// program gets one file in the per-user cache dir, named by a hash of the
+// driver strings and both sources: a driver update or shader edit simply
+// misses, and a binary the driver rejects is recompiled and overwritten.
+struct ProgramBinaryHeader {
+    char     magic[8];   // "C2DPROG1"
+    uint32_t format, length;
+};
+static const char PROGRAM_BINARY_MAGIC[8] = {'C','2','D','P','R','O','G','1'};
+
+static uint64_t fnv1a(uint64_t h, const char* s){
+    for(; *s; s++){ h ^= (unsigned char)*s; h *= 1099511628211ull; }
+    return h*1099511628211ull; // separator, so ("ab","c") != ("a","bc")
+}
+
+// Creates every missing directory of `path` (up to its last '/').
+static void makeParentDirs(const char* path){
+    char dir[1024];
+    for(const char* p = std::strchr(path+1, '/'); p; p = std::strchr(p+1, '/')){
+        size_t n = (size_t)(p - path);
+        if(n >= sizeof(dir)) return;
+        std::memcpy(dir, path, n); dir[n] = 0;
+#ifdef _WIN32
+        _mkdir(dir);      // EEXIST is fine; real failures surface at fopen
+#else
+        mkdir(dir, 0755); // EEXIST is fine; real failures surface at fopen
+#endif
+    }
+}
+
+// <per-user cache dir>/clock2d/<kind>-<hash>.bin
+static bool cacheFilePath(char* out, size_t size, const char* kind, uint64_t h){
+    const char* home = std::getenv("HOME");
+#if defined(__APPLE__)
+    if(!home) return false;
+    char base[768]; std::snprintf(base, sizeof(base), "%s/Library/Caches", home);
+#elif defined(_WIN32)
+    const char* local = std::getenv("LOCALAPPDATA");
+    if(!local) return false;
+    char base[768]; std::snprintf(base, sizeof(base), "%s", local);
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if(!(xdg && *xdg) && !home) return false;
+    char base[768];
+    if(xdg && *xdg) std::snprintf(base, sizeof(base), "%s", xdg);
+    else            std::snprintf(base, sizeof(base), "%s/.cache", home);
+#endif
+    int n = std::snprintf(out, size, "%s/clock2d/%s-%016llx.bin", base, kind, (unsigned long long)h);
+    return n > 0 && (size_t)n < size;
+}
+
+static bool programCachePath(char* out, size_t size, const char* vs, const char* fs){
+    if(!GL_HAS(glProgramBinary) || !GL_HAS(glGetProgramBinary) || !GL_HAS(glProgramParameteri)) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if(formats <= 0) return false;
+    uint64_t h = 14695981039346656037ull;
+    for(GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        h = fnv1a(h, (const char*)glGetString(e));
+    h = fnv1a(fnv1a(h, vs), fs);
+    return cacheFilePath(out, size, "program", h);
+}
+
+// Returns a linked program, or 0 on a miss or a binary the driver rejects.
+static GLuint loadProgramBinary(const char* path){
+    FILE* f = std::fopen(path, "rb");
+    if(!f) return 0;
+    ProgramBinaryHeader hdr;
+    std::vector<char> blob;
+    bool ok = std::fread(&hdr, sizeof(hdr), 1, f) == 1
+           && !std::memcmp(hdr.magic, PROGRAM_BINARY_MAGIC, sizeof(hdr.magic))
+           && hdr.length > 0 && hdr.length < (64u << 20);
+    if(ok){
+        blob.resize(hdr.length);
+        ok = std::fread(blob.data(), 1, blob.size(), f) == blob.size();
+    }
+    std::fclose(f);
+    if(!ok) return 0;
+    // A format this driver does not list would be GL_INVALID_ENUM, not a miss
+    GLint n = 0; glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n);
+    std::vector<GLint> formats(n > 0 ? n : 0);
+    if(n > 0) glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    if(std::find(formats.begin(), formats.end(), (GLint)hdr.format) == formats.end()) return 0;
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, hdr.format, blob.data(), (GLsizei)blob.size());
+    GLint linked = 0; glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if(!linked){ glDeleteProgram(p); return 0; }
+    return p;
+}
+
+static void saveProgramBinary(const char* path, GLuint p){
+    GLint linked = 0, len = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    glGetProgramiv(p, GL_PROGRAM_BINARY_LENGTH, &len);
+    if(!linked || len <= 0) return;
+    std::vector<char> blob(len);
+    GLenum format = 0;
+    glGetProgramBinary(p, len, &len, &format, blob.data());
+    if(len <= 0) return;
+
+    ProgramBinaryHeader hdr;
+    std::memcpy(hdr.magic, PROGRAM_BINARY_MAGIC, sizeof(hdr.magic));
+    hdr.format = format; hdr.length = (uint32_t)len;
+    // Write-then-rename: a reboot mid-write never leaves a torn cache file
+    char tmp[1100]; std::snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    makeParentDirs(path);
+    FILE* f = std::fopen(tmp, "wb");
+    if(!f){ std::fprintf(stderr, "[ProgramCache] cannot write %s\n", tmp); return; }
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1
+           && std::fwrite(blob.data(), 1, (size_t)len, f) == (size_t)len;
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok || std::rename(tmp, path) != 0) std::remove(tmp);
+}
+
+static GLuint makeProgram(const char* vs, const char* fs){
+    char path[1024];
+    const bool cached = programCachePath(path, sizeof(path), vs, fs);
+    if(cached) if(GLuint p = loadProgramBinary(path)) return p;
+    GLuint p = compileProgram(vs, fs, cached);
+    if(cached) saveProgramBinary(path, p);
+    return p;
+}
+
+// ================= Geometry arena (indexed triangles) =================
+// Every mesh lives in one vertex array plus one index array; a Mesh
+// (clock_geom.h) is a base vertex and an index range into them. The arena
+// only hands out ranges: the backend holds the data (GlBackend in buffers
+// its shaders read through texture-buffer views, so no per-mesh VAO or
+// attribute setup exists at all).
+// A fixed slice of the arena's rewritable tail, owned by one mesh group.
+struct DynRegion { int vertex=0, index=0, vertexCap=0, indexCap=0; };
+
+struct GeometryArena {
+    RenderBackend* backend=nullptr;     // storage
+    int dynVertex=0, dynIndex=0;        // next free slot of the rewritable tail
+    int dynVertexEnd=0, dynIndexEnd=0;
+
+    // Static data first, then room for dynVerts/dynIdx of regenerated geometry.
+    void upload(RenderBackend& b, const float* v, int nv, const uint16_t* idx, int ni, int dynVerts=0, int dynIdx=0){
+        backend = &b;
+        dynVertex = nv; dynVertexEnd = nv + dynVerts;
+        dynIndex  = ni; dynIndexEnd  = ni + dynIdx;
+        backend->uploadGeometry(v, nv, idx, ni, dynVertexEnd, dynIndexEnd);
+    }
+    // Carve a region out of the tail; regions live as long as the arena.
+    DynRegion reserve(int nv, int ni){
+        if(dynVertex + nv > dynVertexEnd || dynIndex + ni > dynIndexEnd){
+            std::fprintf(stderr, "[GeometryArena] dynamic tail exhausted\n");
+            return DynRegion{};
+        }
+        DynRegion r{ dynVertex, dynIndex, nv, ni };
+        dynVertex += nv;
+        dynIndex  += ni;
+        return r;
+    }
+    // Map the first nv vertices / ni indices of a region for writing;
+    // generators fill `out` in place, unmapDynamic() hands it back.
+    // Meshes built in `out` map to arena ranges through dynamic().
+    bool mapDynamic(const DynRegion& r, int nv, int ni, SpanGeometry& out){
+        if(nv > r.vertexCap || ni > r.indexCap){
+            std::fprintf(stderr, "[GeometryArena] dynamic region too small\n");
+            return false;
+        }
+        out = SpanGeometry{};
+        out.capV = nv; out.capI = ni;
+        return backend->mapGeometry(r.vertex, nv, r.index, ni, out.v, out.idx);
+    }
+    // False if the backend lost the contents while mapped.
+    bool unmapDynamic(){ return backend->unmapGeometry(); }
+    static Mesh dynamic(const DynRegion& r, Mesh m){
+        m.baseVertex += r.vertex;
+        m.firstIndex += r.index;
+        return m;
+    }
+    // Regenerate a mesh group into its region: size with a counting pass,
+    // then write in place. gen(sink) must emit the same geometry both times.
+    template<class F>
+    bool rebuild(const DynRegion& r, F&& gen){
+        GeometryCounter count;
+        gen(count);
+        SpanGeometry span;
+        if(!mapDynamic(r, count.nv, count.ni, span)) return false;
+        gen(span);
+        return unmapDynamic() && !span.overflow;
+    }
+};
+
+// ================= Dynamic ring buffer =================
+// Per-frame data (render-list records, SDF hand angles) goes through SLOTS
+// regions of one buffer. A slot is only rewritten after the fence issued
+// when the GPU was last handed it has signalled, so the CPU writes frame
+// N+2 while the GPU may still read frame N and no write ever hits an
+// implicit sync. With GL_ARB_buffer_storage the buffer is mapped once
+// (persistent, coherent); otherwise each write maps just its slot
+// unsynchronized, which the fence makes safe.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT   0x0080
+#endif
+typedef void (*BufferStorageProc)(GLenum, GLsizeiptr, const void*, GLbitfield);
+
+struct DynamicRing {
+    static const int SLOTS = 3;
+    GLenum     target=GL_UNIFORM_BUFFER;
+    GLuint     buf=0, binding=0;
+    GLsizeiptr slotSize=0;
+    int        slot=-1;            // slot last committed
+    GLsync     fences[SLOTS] = {};
+    unsigned char* persistent=nullptr;
+
+    void init(GLenum tgt, GLuint bindingIndex, GLsizeiptr bytes){
+        target = tgt; binding = bindingIndex;
+        GLint align = 256;
+        if(target == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+        slotSize = (bytes + align - 1)/align*align;
+        glGenBuffers(1, &buf);
+        glBindBuffer(target, buf);
+        BufferStorageProc bufferStorage = glfwExtensionSupported("GL_ARB_buffer_storage")
+            ? (BufferStorageProc)glfwGetProcAddress("glBufferStorage") : nullptr;
+        if(bufferStorage){
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            bufferStorage(target, SLOTS*slotSize, nullptr, flags);
+            persistent = (unsigned char*)glMapBufferRange(target, 0, SLOTS*slotSize, flags);
+        }
+        if(!persistent){
+            if(bufferStorage){ glDeleteBuffers(1, &buf); glGenBuffers(1, &buf); glBindBuffer(target, buf); }
+            glBufferData(target, SLOTS*slotSize, nullptr, GL_STREAM_DRAW);
+        }
+    }
+    // Pointer to the next free slot (slotSize bytes), or null; commit() it.
+    void* acquire(){
+        // Everything that read the current slot has been submitted by now
+        if(slot >= 0 && !fences[slot]) fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot = (slot + 1) % SLOTS;
+        if(GLsync f = fences[slot]){
+            GLenum r;
+            do r = glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms steps
+            while(r == GL_TIMEOUT_EXPIRED);
+            glDeleteSync(f);
+            fences[slot] = nullptr;
+        }
+        if(persistent) return persistent + slot*slotSize;
+        glBindBuffer(target, buf);
+        void* p = glMapBufferRange(target, slot*slotSize, slotSize,
+                                   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if(!p) std::fprintf(stderr, "[DynamicRing] glMapBufferRange failed\n");
+        return p;
+    }
+    // Makes the slot just written the one bound at `binding`.
+    void commit(){
+        if(!persistent){ glBindBuffer(target, buf); glUnmapBuffer(target); }
+        glBindBufferRange(target, binding, buf, slot*slotSize, slotSize);
+    }
+    // Binds the current slot again (after something else used `binding`).
+    void bind() const {
+        if(slot >= 0) glBindBufferRange(target, binding, buf, slot*slotSize, slotSize);
+    }
+    void destroy(){
+        for(GLsync& f : fences) if(f){ glDeleteSync(f); f = nullptr; }
+        if(buf){
+            if(persistent){ glBindBuffer(target, buf); glUnmapBuffer(target); }
+            glDeleteBuffers(1, &buf);
+        }
+        buf = 0; persistent = nullptr; slot = -1;
     }
-    void draw() const {
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, count);
-        glBindVertexArray(0);
+};
+
+// Framebuffer frames are presented to: 0 (the window) or the export target.
+static GLuint g_targetFbo = 0;
+
+// ================= Dial layer (offscreen cache) =================
+// The dial never changes between frames, so it is rendered once into a
+// multisampled FBO, resolved into a texture, and composited with one draw.
+// Rebuilt only when the framebuffer size or the theme changes.
+struct DialLayer {
+    GLuint msFbo=0, msRbo=0;   // multisampled render target
+    GLuint fbo=0, tex=0;       // resolved color texture
+    int w=0, h=0, samples=-1;
+    bool ok=false;
+
+    // Returns true when the layer was (re)allocated and must be redrawn.
+    bool resize(int W, int H, int S){
+        if(W==w && H==h && S==samples) return false;
+        destroy();
+        w = W; h = H; samples = S;
+        GLint maxS=0; glGetIntegerv(GL_MAX_SAMPLES, &maxS);
+        if(samples > maxS) samples = maxS;
+
+        glGenRenderbuffers(1, &msRbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, msRbo);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, W, H);
+        glGenFramebuffers(1, &msFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msRbo);
+        ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, W, H, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        ok = ok && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, g_targetFbo);
+        if(!ok) std::fprintf(stderr, "[DialLayer] FBO incomplete, drawing dial directly\n");
+        return true;
+    }
+    void begin() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+        glViewport(0,0,w,h);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    void end() const {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, msFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+        glBlitFramebuffer(0,0,w,h, 0,0,w,h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, g_targetFbo);
+    }
+    // Attribute-less; core profile only needs *a* VAO bound (the render list's).
+    void composite(GLuint prog) const {
+        glUseProgram(prog);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        g_draws.draws++;
+        g_draws.verts += 3;
     }
     void destroy(){
-        if(vbo) glDeleteBuffers(1, &vbo);
-        if(vao) glDeleteVertexArrays(1, &vao);
-        vbo = vao = 0;
+        if(fbo)   glDeleteFramebuffers(1, &fbo);
+        if(tex)   glDeleteTextures(1, &tex);
+        if(msFbo) glDeleteFramebuffers(1, &msFbo);
+        if(msRbo) glDeleteRenderbuffers(1, &msRbo);
+        fbo = tex = msFbo = msRbo = 0;
+        w = h = 0; samples = -1; ok = false;
+    }
+};
+
+// ================= Baked clock geometry =================
+// All static meshes, generated at compile time into one read-only vertex
+// table and one index table; startup is a single glBufferData per buffer.
+// The bezel, face and chapter ring are tessellated per framebuffer size by
+// DialLod instead.
+constexpr GeometryCounter CLOCK_SIZE = []{ GeometryCounter c; genClockGeometry(c); return c; }();
+
+struct BakedClock {
+    FixedGeometry<CLOCK_SIZE.nv, CLOCK_SIZE.ni> geo;
+    ClockMeshes meshes;
+};
+static constexpr BakedClock BAKED_CLOCK = []{
+    BakedClock b{};
+    b.meshes = genClockGeometry(b.geo);
+    return b;
+}();
+
+// ================= Tessellation LOD for the dial circles =================
+// Segment counts come from lodSegments (clock_geom); meshes are regenerated
+// into the arena's dynamic tail only when a bucket changes.
+struct DialLod {
+    DynRegion region;
+    int ringSeg=0, discSeg=0;
+    float radii[4] = {};             // bezel inner/outer, ring inner/outer built
+    Mesh bezel, face, innerRing;     // arena ranges
+
+    // Two rings (2n verts, 6n indices) and a disc (n+1 verts, 3n indices)
+    static int maxVerts()  { return 5*LOD_MAX_SEG + 1; }
+    static int maxIndices(){ return 15*LOD_MAX_SEG; }
+
+    void init(GeometryArena& arena){ region = arena.reserve(maxVerts(), maxIndices()); }
+
+    // Returns true when the meshes changed: a new segment bucket, or new
+    // radii from the theme. The face is a unit disc, scaled by its record.
+    bool update(int W, int H, GeometryArena& arena, const ClockShape& s){
+        float rpx = 0.5f*(float)(W > H ? W : H); // NDC radius 1, longer axis
+        int rs = lodSegments(s.bezelOuter*rpx);
+        int ds = lodSegments(s.bezelInner*rpx);
+        const float r[4] = { s.bezelInner, s.bezelOuter, s.ringInner, s.ringOuter };
+        if(rs==ringSeg && ds==discSeg && !std::memcmp(r, radii, sizeof(r))) return false;
+        ringSeg = rs; discSeg = ds;
+        std::memcpy(radii, r, sizeof(r));
+
+        Mesh b, f, c;
+        bool ok = arena.rebuild(region, [&](auto& g){
+            g.begin(); genRing(g, rs, s.bezelOuter, s.bezelInner); b = g.end(); // outer bezel ring
+            g.begin(); genDisc(g, ds, 1.0f);                       f = g.end(); // white dial disc
+            g.begin(); genRing(g, rs, s.ringOuter, s.ringInner);   c = g.end(); // chapter ring
+        });
+        if(!ok) return false;
+        bezel     = GeometryArena::dynamic(region, b);
+        face      = GeometryArena::dynamic(region, f);
+        innerRing = GeometryArena::dynamic(region, c);
+        return true;
     }
 };
 
-// ================= Geometry utils =================
-static void addTri(std::vector<float>& v, float x1,float y1,float x2,float y2,float x3,float y3){
-    v.insert(v.end(), {x1,y1, x2,y2, x3,y3});
-}
-static void addBox(std::vector<float>& v, float x0,float y0,float x1,float y1){
-    addTri(v, x0,y0, x1,y0, x1,y1);
-    addTri(v, x0,y0, x1,y1, x0,y1);
-}
-static void genDisc(std::vector<float>& v, int seg=128, float r=1.0f){
-    v.clear();
-    for(int i=0;i<seg;i++){
-        float a0 = 2.0f*M_PI*(i/(float)seg);
-        float a1 = 2.0f*M_PI*((i+1)/(float)seg);
-        addTri(v, 0,0, r*std::cos(a0), r*std::sin(a0), r*std::cos(a1), r*std::sin(a1));
-    }
-}
-static void genRing(std::vector<float>& v, int seg, float r0, float r1){
-    v.clear();
-    for(int i=0;i<seg;i++){
-        float a0 = 2.0f*M_PI*(i/(float)seg);
-        float a1 = 2.0f*M_PI*((i+1)/(float)seg);
-        float c0=std::cos(a0), s0=std::sin(a0);
-        float c1=std::cos(a1), s1=std::sin(a1);
-        // two tris per slice
-        addTri(v, c0*r0,s0*r0, c0*r1,s0*r1, c1*r1,s1*r1);
-        addTri(v, c0*r0,s0*r0, c1*r1,s1*r1, c1*r0,s1*r0);
-    }
-}
-// radial tick (filled quad) centered on angle 'a', from innerR..outerR with tangential half-width 'halfW'
-static void addRadialBar(std::vector<float>& v, float a, float innerR, float outerR, float halfW){
-    float ca=std::cos(a), sa=std::sin(a);
-    float tx=-sa, ty=ca; // tangent unit
-    // four corners (inner/outer, left/right)
-    float ix=ca*innerR, iy=sa*innerR;
-    float ox=ca*outerR, oy=sa*outerR;
-    float ilx=ix - tx*halfW, ily=iy - ty*halfW;
-    float irx=ix + tx*halfW, iry=iy + ty*halfW;
-    float olx=ox - tx*halfW, oly=oy - ty*halfW;
-    float orx=ox + tx*halfW, ory=oy + ty*halfW;
-    // two triangles
-    addTri(v, ilx,ily, irx,iry, orx,ory);
-    addTri(v, ilx,ily, orx,ory, olx,oly);
-}
-static void genTicksQuads(std::vector<float>& v, int count, float innerR, float outerR, float width){
-    v.clear();
-    float halfW = width*0.5f;
-    for(int i=0;i<count;i++){
-        float a = 2.0f*M_PI*(i/(float)count);
-        addRadialBar(v, a, innerR, outerR, halfW);
-    }
-}
-
-// ================= Hands (resized to fit) =================
-// Hour: short spade-like rectangle + short tail
-static void genHourHand(std::vector<float>& v){
-    v.clear();
-    const float L    = 0.50f;  // reach
-    const float W    = 0.10f;  // width
-    const float TAIL = 0.06f;  // tail
-    addBox(v, -0.5f*W, 0.0f,  0.5f*W, L);
-    addBox(v, -0.5f*W,-TAIL,  0.5f*W, 0.0f);
-}
-// Minute: longer, tapered pointer + small tail
-static void genMinuteHand(std::vector<float>& v){
-    v.clear();
-    const float L    = 0.72f;
-    const float W    = 0.06f;
-    const float TAIL = 0.08f;
-    addBox(v, -0.5f*W, 0.0f,  0.5f*W, L-0.10f);
-    addTri(v, -0.45f*W, L-0.10f,  0.45f*W, L-0.10f,  0.0f, L);
-    addBox(v, -0.5f*W,-TAIL,  0.5f*W, 0.0f);
-}
-// Second: thin needle + counterweight tail + small hub
-static void genSecondHand(std::vector<float>& v){
-    v.clear();
-    const float L      = 0.82f;
-    const float W      = 0.018f;
-    const float TAIL_L = 0.15f;
-    const float HUB_R  = 0.030f;
-    addBox(v, -0.5f*W, 0.0f,  0.5f*W, L);          // needle
-    addBox(v, -0.5f*W,-TAIL_L, 0.5f*W, 0.0f);      // tail
-    // hub disc
-    std::vector<float> fan; genDisc(fan, 32, HUB_R);
-    v.insert(v.end(), fan.begin(), fan.end());
-}
-
-// ================= Numerals (filled block digits) =================
-// Compact, high-contrast block numerals in [-0.5..0.5]^2
-static void genDigitMesh(std::vector<float>& v, int d){
-    v.clear();
-    auto box = [&](float x0,float y0,float x1,float y1){ addBox(v,x0,y0,x1,y1); };
-    switch(d){
-        case 0: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f);
-                box(-0.45f,-0.55f,-0.25f, 0.55f);
-                box( 0.25f,-0.55f, 0.45f, 0.55f); break;
-        case 1: box( 0.10f,-0.55f, 0.30f, 0.55f); break; // slimmer '1' for clarity
-        case 2: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box( 0.25f, 0.15f, 0.45f, 0.35f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box(-0.45f,-0.55f,-0.25f,-0.35f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
-        case 3: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box( 0.25f, 0.15f, 0.45f, 0.35f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box( 0.25f,-0.35f, 0.45f,-0.15f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
-        case 4: box(-0.45f, 0.05f,-0.25f, 0.55f);
-                box( 0.25f, 0.05f, 0.45f, 0.55f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box( 0.25f,-0.55f, 0.45f,-0.05f); break;
-        case 5: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box(-0.45f, 0.15f,-0.25f, 0.35f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box( 0.25f,-0.35f, 0.45f,-0.15f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f); break;
-        case 6: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box(-0.45f,-0.05f,-0.25f, 0.35f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box( 0.25f,-0.35f, 0.45f,-0.15f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f);
-                // add a small vertical to clarify '6'
-                box(-0.45f, -0.35f, -0.25f, -0.15f); break;
-        case 7: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box( 0.25f,-0.55f, 0.45f, 0.35f); break;
-        case 8: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box(-0.45f,-0.55f, 0.45f,-0.35f);
-                box(-0.45f,-0.55f,-0.25f, 0.55f);
-                box( 0.25f,-0.55f, 0.45f, 0.55f); break;
-        case 9: box(-0.45f, 0.35f, 0.45f, 0.55f);
-                box(-0.45f, 0.15f,-0.25f, 0.55f);
-                box(-0.45f,-0.05f, 0.45f, 0.15f);
-                box( 0.25f,-0.55f, 0.45f,-0.15f); break;
-    }
-}
-
-// Build meshes for numerals 1..12, composing tens+ones for 10,11,12
-struct NumeralMesh { Mesh mesh; };
-static void buildNumerals(std::vector<NumeralMesh>& out){
-    out.resize(13); // index 1..12
-    for(int n=1;n<=12;n++){
-        std::vector<float> verts, tens, ones;
-        if(n<10){
-            genDigitMesh(ones, n);
-            // scale down a touch horizontally so two-digit looks balanced
-            // (we’ll rely on global scale at draw, so just keep as-is)
-            verts.insert(verts.end(), ones.begin(), ones.end());
-        }else{
-            int t = n/10, o = n%10;
-            genDigitMesh(tens, t);
-            genDigitMesh(ones, o);
-            // place tens left, ones right with small gap
-            const float dx = 0.75f; // center offset
-            const float gap= 0.10f; // between digits
-            // tens -> shift left
-            for(size_t i=0;i<tens.size(); i+=2){ verts.push_back(tens[i] - dx - gap); verts.push_back(tens[i+1]); }
-            // ones -> shift right
-            for(size_t i=0;i<ones.size(); i+=2){ verts.push_back(ones[i] + dx + gap); verts.push_back(ones[i+1]); }
-        }
-        out[n].mesh.init(verts);
+// ================= Text (glyph atlas) =================
+// A string is one record per glyph: the shared unit quad scaled to an atlas
+// cell and tagged with it (DrawRecord::glyph), so text joins whatever layer
+// it is added to. The atlas is packed once per font and character set and
+// kept in the cache dir next to the program binaries.
+static const char* const TEXT_CHARSET = " -./:0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const float NUMERAL_CAP = 1.1f;    // cap height per unit of numeral scale (the old digit boxes)
+static const int   MAX_NUMERAL_GLYPHS = 4; // per numeral: the SDF dial's slots
+
+static const char* const ARABIC_NUMERALS[12] = {
+    "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12" };
+static const char* const ROMAN_NUMERALS[12] = { // IIII: the watchmaker's four
+    "I", "II", "III", "IIII", "V", "VI", "VII", "VIII", "IX", "X", "XI", "XII" };
+
+static void loadGlyphAtlas(GlyphAtlas& atlas, const Font& font, const std::vector<uint32_t>& cps){
+    const uint64_t key = GlyphAtlas::key(font, cps);
+    char path[1024];
+    const bool cached = cacheFilePath(path, sizeof(path), "atlas", key);
+    if(cached && atlas.load(path, key)) return;
+    atlas.build(font, cps);
+    if(cached){ makeParentDirs(path); atlas.save(path, key); }
+}
+
+// The atlas on texture unit 4, for FS_SRC's glyphs and the SDF dial.
+struct AtlasTexture {
+    GLuint tex=0;
+    void init(const GlyphAtlas& a){
+        glGenTextures(1, &tex);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        // rows are CELL*COLS bytes: no unpack alignment to change
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, a.width, a.height, 0, GL_RED, GL_UNSIGNED_BYTE, a.texels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glActiveTexture(GL_TEXTURE0);
     }
+    static void bind(GLuint prog, const GlyphAtlas& a){
+        glUseProgram(prog);
+        glUniform1i(glGetUniformLocation(prog, "uAtlas"), 4);
+        glUniform2f(glGetUniformLocation(prog, "uAtlasCells"), (float)GlyphAtlas::COLS, (float)a.rows);
+    }
+    void destroy(){
+        if(tex) glDeleteTextures(1, &tex);
+        tex = 0;
+    }
+};
+
+// emit(cell, x, y, side) for each glyph of `text`, centered on (cx, cy);
+// cap is the cap height in the caller's units, side the quad's.
+template<class F>
+static void forEachTextGlyph(const GlyphAtlas& atlas, const char* text, float cx, float cy, float cap, F&& emit){
+    std::vector<PlacedGlyph> run;
+    const float w = layoutText(atlas, text, run);
+    for(const PlacedGlyph& g : run)
+        emit(g.cell, cx + (g.x - 0.5f*w)*cap, cy + (g.y - 0.5f)*cap, GlyphAtlas::CELL_CAPS*cap);
+}
+static DrawRecord glyphRecord(int cell, float side, float x, float y, const float rgb[3]){
+    DrawRecord d = makeRecord(rgb[0], rgb[1], rgb[2], side, side, x, y);
+    d.glyph = (float)(cell + 1);
+    return d;
 }
 
-// ================= Time helper =================
-static double nowSeconds(){
-    using namespace std::chrono;
-    auto tp = system_clock::now();
-    auto s  = time_point_cast<seconds>(tp);
-    return (double)s.time_since_epoch().count()
-         + duration<double>(tp - s).count();
+// emit(n, cell, x, y, side) for each glyph of numerals 1..12.
+template<class F>
+static void forEachNumeralGlyph(const GlyphAtlas& atlas, const char* const labels[12],
+                                float rNum, float sNum, F&& emit){
+    forEachNumeral(rNum, [&](int n, float cx, float cy){
+        forEachTextGlyph(atlas, labels[n-1], cx, cy, NUMERAL_CAP*sNum,
+                         [&](int cell, float x, float y, float side){ emit(n, cell, x, y, side); });
+    });
+}
+static int addNumerals(RenderList& rl, const GlyphAtlas& atlas, const Mesh& quad,
+                       const char* const labels[12], float rNum, float sNum){
+    int first = (int)rl.records.size();
+    const float black[3] = { 0.0f, 0.0f, 0.0f };
+    forEachNumeralGlyph(atlas, labels, rNum, sNum, [&](int, int cell, float x, float y, float side){
+        rl.add(quad, glyphRecord(cell, side, x, y, black));
+    });
+    return first;
+}
+// Moves the records made by addNumerals to a new radius/scale.
+static void layoutNumerals(RenderList& rl, int first, const GlyphAtlas& atlas,
+                           const char* const labels[12], float rNum, float sNum){
+    int id = first;
+    forEachNumeralGlyph(atlas, labels, rNum, sNum, [&](int, int, float x, float y, float side){
+        setTransform(rl.records[id++], 0.0f, side, side, x, y);
+    });
 }
 
-// ================= Main =================
-int main(){
-    if(!glfwInit()){ std::fprintf(stderr,"GLFW init failed\n"); return 1; }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,2);
-    glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT,GL_TRUE);
-    glfwWindowHint(GLFW_SAMPLES,4);
-
-    GLFWwindow* win = glfwCreateWindow(800,800,"Analog Clock",nullptr,nullptr);
-    if(!win){ glfwTerminate(); return 1; }
-    glfwMakeContextCurrent(win);
-    glfwSwapInterval(1);
-
-    GLuint prog = makeProgram(VS_SRC, FS_SRC);
-    glUseProgram(prog);
-    GLint uAng = glGetUniformLocation(prog,"uAngle");
-    GLint uSc  = glGetUniformLocation(prog,"uScale");
-    GLint uTr  = glGetUniformLocation(prog,"uTrans");
-    GLint uCol = glGetUniformLocation(prog,"uColor");
-
-    // Dial geometry
-    std::vector<float> v;
-    genRing(v, 256, 0.98f, 0.86f); Mesh bezel;     bezel.init(v);   // outer bezel ring
-    genDisc(v, 128, 1.0f);         Mesh face;      face.init(v);    // white dial disc
-    genRing(v, 256, 0.84f, 0.82f); Mesh innerRing; innerRing.init(v); // chapter ring
-
-    // Ticks (filled quads so they’re crisp on macOS)
-    genTicksQuads(v, 60, 0.82f, 0.88f, 0.010f); Mesh minuteTicks; minuteTicks.init(v); // thin
-    genTicksQuads(v, 12, 0.78f, 0.90f, 0.020f); Mesh hourTicks;   hourTicks.init(v);   // bold
-
-    // Hands
-    genHourHand(v);   Mesh hourHand;   hourHand.init(v);
-    genMinuteHand(v); Mesh minuteHand; minuteHand.init(v);
-    genSecondHand(v); Mesh secondHand; secondHand.init(v);
-
-    // Numerals (1..12)
-    std::vector<NumeralMesh> numerals; buildNumerals(numerals);
-
-    glEnable(GL_MULTISAMPLE);
-    glClearColor(1,1,1,1);
-
-    const double TAU = 6.28318530718;
-    auto numeralAngle = [&](int n)->float{
-        int idx = n % 12; // 12→0
-        return float(-TAU*(idx/12.0f) + TAU*0.25f);
+// ================= Theme =================
+// Colors and every ClockShape dimension, loaded from a text file that is
+// watched while running. One "key values..." per line, '#' comments; keys
+// left out keep the stock value, so deleting a line reverts it.
+//   color.<part> r g b     bezel face ring ticks numerals hour minute second background
+//   bezel.inner r | bezel.outer r | ring.inner r | ring.outer r
+//   ticks.minute count inner outer width   (same for ticks.hour)
+//   hand.hour length width tail            (same for hand.minute, hand.second)
+//   hand.hub radius
+//   numerals radius scale
+enum ThemeColor { TC_BEZEL, TC_FACE, TC_RING, TC_TICKS, TC_NUMERALS,
+                  TC_HOUR, TC_MINUTE, TC_SECOND, TC_BACKGROUND, TC_COUNT };
+static const char* THEME_COLOR_NAMES[TC_COUNT] = {
+    "bezel", "face", "ring", "ticks", "numerals", "hour", "minute", "second", "background" };
+
+struct Theme {
+    ClockShape shape;
+    float color[TC_COUNT][3] = {
+        { 0.42f, 0.22f, 0.12f },   // subtle brown
+        { 1.0f,  1.0f,  1.0f  },   // white dial
+        { 0.75f, 0.75f, 0.75f },   // chapter ring
+        { 0.0f,  0.0f,  0.0f  },   // ticks
+        { 0.0f,  0.0f,  0.0f  },   // numerals
+        { 0.0f,  0.0f,  0.0f  },   // hour: black
+        { 0.0f,  0.0f,  0.0f  },   // minute: black
+        { 0.80f, 0.70f, 0.35f },   // second: gold
+        { 1.0f,  1.0f,  1.0f  },   // background
+    };
+};
+
+// On any error the file is rejected as a whole and `out` is left alone.
+static bool loadTheme(const char* path, Theme& out){
+    FILE* f = std::fopen(path, "r");
+    if(!f){ std::fprintf(stderr, "[Theme] cannot open %s\n", path); return false; }
+    Theme t;
+    ClockShape& s = t.shape;
+    struct { const char* key; float* v; } scalars[] = {
+        { "bezel.inner", &s.bezelInner }, { "bezel.outer", &s.bezelOuter },
+        { "ring.inner",  &s.ringInner  }, { "ring.outer",  &s.ringOuter  },
+        { "hand.hub",    &s.hubRadius  },
     };
+    struct { const char* key; TickSpec* v; } ticks[] = {
+        { "ticks.minute", &s.minuteTicks }, { "ticks.hour", &s.hourTicks } };
+    struct { const char* key; HandSpec* v; } hands[] = {
+        { "hand.hour", &s.hour }, { "hand.minute", &s.minute }, { "hand.second", &s.second } };
+
+    char line[256];
+    int  lineNo = 0;
+    bool ok = true;
+    while(std::fgets(line, sizeof(line), f)){
+        lineNo++;
+        if(char* c = std::strchr(line, '#')) *c = 0;
+        char  key[64];
+        float a[4];
+        int n = std::sscanf(line, "%63s %f %f %f %f", key, &a[0], &a[1], &a[2], &a[3]);
+        if(n < 1) continue; // blank
+        int  args  = n - 1;
+        bool known = false;
+        auto want = [&](int k){
+            known = true;
+            if(args == k) return true;
+            std::fprintf(stderr, "[Theme] %s:%d: %s takes %d value%s\n", path, lineNo, key, k, k==1 ? "" : "s");
+            ok = false;
+            return false;
+        };
+        for(int i=0; i<TC_COUNT; i++){
+            if(std::strncmp(key, "color.", 6) || std::strcmp(key+6, THEME_COLOR_NAMES[i])) continue;
+            if(want(3)) for(int j=0; j<3; j++) t.color[i][j] = std::min(1.0f, std::max(0.0f, a[j]));
+        }
+        for(auto& k : scalars) if(!std::strcmp(key, k.key) && want(1)) *k.v = a[0];
+        for(auto& k : ticks) if(!std::strcmp(key, k.key) && want(4))
+            *k.v = TickSpec{ std::min(MAX_TICKS, std::max(0, (int)a[0])), a[1], a[2], a[3] };
+        for(auto& k : hands) if(!std::strcmp(key, k.key) && want(3)) *k.v = HandSpec{ a[0], a[1], a[2] };
+        if(!std::strcmp(key, "numerals") && want(2)){ s.numeralRadius = a[0]; s.numeralScale = a[1]; }
+        if(!known){
+            std::fprintf(stderr, "[Theme] %s:%d: unknown key '%s'\n", path, lineNo, key);
+            ok = false;
+        }
+    }
+    std::fclose(f);
+    if(ok) out = t;
+    return ok;
+}
+
+// Arena room for themed ticks (up to MAX_TICKS per ring) and hands (fixed
+// topology, only dimensions change).
+constexpr GeometryCounter THEME_TICKS_SIZE = []{
+    ClockShape s;
+    s.minuteTicks.count = s.hourTicks.count = MAX_TICKS;
+    GeometryCounter c; Mesh a, b;
+    genTickMeshes(c, s, a, b);
+    return c;
+}();
+constexpr GeometryCounter THEME_HANDS_SIZE = []{
+    GeometryCounter c; Mesh a, b, d;
+    genHandMeshes(c, ClockShape{}, a, b, d);
+    return c;
+}();
+
+// Polled once per frame wake-up; size is checked too since mtime may only
+// have one-second resolution.
+struct ThemeWatcher {
+    const char* path=nullptr;
+    std::time_t mtime=0;
+    long long   size=-1;
+    bool changed(){
+        struct stat st;
+        if(!path || stat(path, &st) != 0) return false;
+        if(st.st_mtime == mtime && (long long)st.st_size == size) return false;
+        mtime = st.st_mtime;
+        size  = (long long)st.st_size;
+        return true;
+    }
+};
+
+// ================= Complications =================
+// Instances from complications.h become render-list records: solid meshes
+// from the arena region their geometry is copied into, glyphs on the unit
+// quad. Face parts join the cached dial layer; live ones form one layer
+// drawn for every dial (recordStride = liveCount) under the hands.
+static const ThemeColor COMPLICATION_COLORS[CC_COUNT] = {
+    TC_FACE, TC_RING, TC_TICKS, TC_NUMERALS, TC_HOUR, TC_SECOND };
+
+static DrawRecord complicationRecord(const ComplicationInstance& in, float cx, float cy, const Theme& t){
+    const float* c = t.color[COMPLICATION_COLORS[in.color]];
+    DrawRecord d = makeRecord(c[0], c[1], c[2]);
+    setTransform(d, in.angle, in.sx, in.sy, cx + in.x, cy + in.y);
+    d.glyph = (float)(in.glyph + 1);
+    return d;
+}
+
+// ================= SDF dial (analytic alternative) =================
+// Face, bezel, chapter ring, ticks, numerals and hands evaluated as signed
+// distance fields over one fullscreen triangle, anti-aliased with fwidth.
+// Needs no MSAA and is resolution independent. Dimensions come from the
+// theme's ClockShape; numerals read the glyph atlas's distance fields. In a
+// dashboard grid each pixel evaluates only the dial of its own cell.
+static const char* SDF_FS_SRC = R"GLSL(
+#version 150 core
+out vec4 FragColor;
+uniform vec2  uRes;
+uniform vec2  uGrid;       // dashboard columns, rows
+uniform int   uClockCount;
+layout(std140) uniform SdfHands { vec4 uHands[128]; }; // per dial: (cos,sin) hour, minute; second, -
+uniform vec3  uColor[9];   // bezel, face, ring, ticks, numerals, hour, minute, second, background
+uniform vec4  uDialR;      // bezel inner, bezel outer, ring inner, ring outer
+uniform vec4  uTickM;      // minute ticks: count, inner, outer, half width
+uniform vec4  uTickH;      // hour ticks
+uniform vec4  uHandH;      // length, half width, tail, -
+uniform vec4  uHandM;
+uniform vec4  uHandS;      // .w: hub radius
+uniform sampler2D uAtlas;  // GlyphAtlas distance fields, 0.5 = edge
+uniform vec2  uAtlasCells; // columns, rows
+uniform vec4  uNum[48];    // four glyph slots per numeral position: (x, y, atlas cell, used)
+uniform vec2  uGlyphSize;  // quad side, distance per unit of atlas value
+
+const float TAU = 6.28318530718;
+
+float sdRect(vec2 p, vec4 r){
+    vec2 d = abs(p - 0.5*(r.xy + r.zw)) - 0.5*(r.zw - r.xy);
+    return length(max(d, 0.0)) + min(max(d.x, d.y), 0.0);
+}
+float sdAnnulus(float r, float r0, float r1){ return abs(r - 0.5*(r0 + r1)) - 0.5*(r1 - r0); }
+// apex at the origin, base from (-q.x, q.y) to (q.x, q.y)
+float sdTriIsosceles(vec2 p, vec2 q){
+    p.x = abs(p.x);
+    vec2 a = p - q*clamp(dot(p, q)/dot(q, q), 0.0, 1.0);
+    vec2 b = p - q*vec2(clamp(p.x/q.x, 0.0, 1.0), 1.0);
+    float s = -sign(q.y);
+    vec2 d = min(vec2(dot(a, a), s*(p.x*q.y - p.y*q.x)),
+                 vec2(dot(b, b), s*(p.y - q.y)));
+    return -sqrt(d.x)*sign(d.y);
+}
+float sdTicks(vec2 p, vec4 t){
+    float n = t.x, r0 = t.y, r1 = t.z, hw = t.w;
+    if(n < 0.5) return 1e3;
+    float step = TAU/n;
+    float k = floor(atan(p.y, p.x)/step + 0.5);
+    float c = cos(k*step), s = sin(k*step);
+    vec2 q = vec2(c*p.x + s*p.y, -s*p.x + c*p.y);
+    return sdRect(q, vec4(r0, -hw, r1, hw));
+}
+float sdNumerals(vec2 p){
+    // only the numeral whose 30° sector contains p can be close
+    int slot = int(mod(floor((0.25*TAU - atan(p.y, p.x))/(TAU/12.0) + 0.5), 12.0));
+    float d = 1e3;
+    for(int j=0; j<4; j++){
+        vec4 inst = uNum[4*slot + j];
+        vec2 q = (p - inst.xy)/uGlyphSize.x + 0.5; // in the glyph's cell
+        if(inst.w < 0.5 || q != clamp(q, 0.0, 1.0)) continue;
+        vec2 uv = (vec2(mod(inst.z, uAtlasCells.x), floor(inst.z/uAtlasCells.x)) + q)/uAtlasCells;
+        d = min(d, (0.5 - textureLod(uAtlas, uv, 0.0).r)*uGlyphSize.y);
+    }
+    return d;
+}
+vec2 toHand(vec2 p, vec2 cs){ return vec2(cs.x*p.x + cs.y*p.y, -cs.y*p.x + cs.x*p.y); }
+
+// AA width from the pixel footprint rather than fwidth(d): the sector and
+// min() seams make d's derivatives discontinuous.
+float gAA;
+float cover(float d){ return clamp(0.5 - d/gAA, 0.0, 1.0); }
+
+void main(){
+    vec2 uv   = gl_FragCoord.xy/uRes;
+    vec2 cell = floor(uv*uGrid);
+    int  k    = int(uGrid.y - 1.0 - cell.y)*int(uGrid.x) + int(cell.x); // row-major from the top
+    if(k >= uClockCount){ FragColor = vec4(uColor[8], 1.0); return; }
+    vec2 p = fract(uv*uGrid)*2.0 - 1.0;
+    gAA = length(2.0*uGrid/uRes)*0.7071;
+    float r = length(p);
+    vec4 h0 = uHands[2*k], h1 = uHands[2*k + 1];
+    vec2 ph = toHand(p, h0.xy);
+    vec2 pm = toHand(p, h0.zw);
+    vec2 ps = toHand(p, h1.xy);
+
+    float dBezel = sdAnnulus(r, uDialR.x, uDialR.y);
+    float dFace  = r - uDialR.x;
+    float dRing  = sdAnnulus(r, uDialR.z, uDialR.w);
+    float dTicks = min(sdTicks(p, uTickM), sdTicks(p, uTickH));
+    float dNum   = sdNumerals(p);
+    float dHour  = sdRect(ph, vec4(-uHandH.y, -uHandH.z, uHandH.y, uHandH.x));
+    float dMin   = min(sdRect(pm, vec4(-uHandM.y, -uHandM.z, uHandM.y, uHandM.x - 0.10 + gAA)), // overlap hides the seam
+                       sdTriIsosceles(vec2(pm.x, uHandM.x - pm.y), vec2(0.9*uHandM.y, 0.10)));
+    float dSec   = min(sdRect(ps, vec4(-uHandS.y, -uHandS.z, uHandS.y, uHandS.x)), length(ps) - uHandS.w);
+
+    vec3 col = uColor[8];
+    col = mix(col, uColor[0], cover(dBezel));
+    col = mix(col, uColor[1], cover(dFace));
+    col = mix(col, uColor[2], cover(dRing));
+    col = mix(col, uColor[3], cover(dTicks));
+    col = mix(col, uColor[4], cover(dNum));
+    col = mix(col, uColor[5], cover(dHour));
+    col = mix(col, uColor[6], cover(dMin));
+    col = mix(col, uColor[7], cover(dSec));
+    FragColor = vec4(col, 1.0);
+}
+)GLSL";
+
+struct SdfDial {
+    GLuint prog=0;
+    DynamicRing handRing;      // SdfHands UBO
+    GLint  uRes=-1, uGrid=-1, uClockCount=-1;
+    std::vector<float> hands;  // 8 floats per dial, SdfHands layout
+    const GlyphAtlas*  atlas=nullptr;
+    const char* const* labels=nullptr; // numerals 1..12
+
+    void init(const Theme& theme, const GlyphAtlas& a, const char* const numerals[12]){
+        atlas = &a; labels = numerals;
+        prog = makeProgram(COMPOSITE_VS_SRC, SDF_FS_SRC);
+        glUseProgram(prog);
+        uRes        = glGetUniformLocation(prog, "uRes");
+        uGrid       = glGetUniformLocation(prog, "uGrid");
+        uClockCount = glGetUniformLocation(prog, "uClockCount");
+        glUniformBlockBinding(prog, glGetUniformBlockIndex(prog, "SdfHands"), 2);
+        handRing.init(GL_UNIFORM_BUFFER, 2, MAX_CLOCKS*8*sizeof(float));
+        hands.assign(MAX_CLOCKS*8, 0.0f);
+        AtlasTexture::bind(prog, a);
+        setTheme(theme);
+    }
+    void setTheme(const Theme& t){
+        const ClockShape& s = t.shape;
+        glUseProgram(prog);
+        glUniform3fv(glGetUniformLocation(prog, "uColor"), TC_COUNT, &t.color[0][0]);
+        glUniform4f(glGetUniformLocation(prog, "uDialR"), s.bezelInner, s.bezelOuter, s.ringInner, s.ringOuter);
+        auto ticks = [&](const char* name, const TickSpec& k){
+            glUniform4f(glGetUniformLocation(prog, name), (float)k.count, k.inner, k.outer, 0.5f*k.width);
+        };
+        ticks("uTickM", s.minuteTicks);
+        ticks("uTickH", s.hourTicks);
+        auto hand = [&](const char* name, const HandSpec& h, float w){
+            glUniform4f(glGetUniformLocation(prog, name), h.length, 0.5f*h.width, h.tail, w);
+        };
+        hand("uHandH", s.hour,   0.0f);
+        hand("uHandM", s.minute, 0.0f);
+        hand("uHandS", s.second, s.hubRadius);
+
+        std::array<float, 12*MAX_NUMERAL_GLYPHS*4> num{};
+        std::array<int, 12> used{};
+        forEachNumeralGlyph(*atlas, labels, s.numeralRadius, s.numeralScale, [&](int n, int cell, float x, float y, float){
+            if(used[n%12] == MAX_NUMERAL_GLYPHS) return;
+            int slot = MAX_NUMERAL_GLYPHS*(n%12) + used[n%12]++;
+            num[4*slot+0] = x; num[4*slot+1] = y; num[4*slot+2] = (float)cell; num[4*slot+3] = 1.0f;
+        });
+        const float cap = NUMERAL_CAP*s.numeralScale;
+        glUniform4fv(glGetUniformLocation(prog, "uNum"), 12*MAX_NUMERAL_GLYPHS, num.data());
+        glUniform2f(glGetUniformLocation(prog, "uGlyphSize"), GlyphAtlas::CELL_CAPS*cap, 2.0f*GlyphAtlas::SPREAD*cap);
+    }
+    // angles: hour, minute, second per dial
+    void draw(int W, int H, const float* angles, int n, int cols, int rows){
+        for(int k=0; k<n; k++){
+            float* h = &hands[8*k];
+            const float* a = &angles[3*k];
+            h[0] = std::cos(a[0]); h[1] = std::sin(a[0]);
+            h[2] = std::cos(a[1]); h[3] = std::sin(a[1]);
+            h[4] = std::cos(a[2]); h[5] = std::sin(a[2]);
+        }
+        if(void* p = handRing.acquire()){
+            std::memcpy(p, hands.data(), n*8*sizeof(float));
+            handRing.commit();
+        }
+        glUseProgram(prog);
+        glUniform2f(uRes, (float)W, (float)H);
+        glUniform2f(uGrid, (float)cols, (float)rows);
+        glUniform1i(uClockCount, n);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        g_draws.draws++;
+        g_draws.verts += 3;
+    }
+    void destroy(){
+        handRing.destroy();
+        if(prog) glDeleteProgram(prog);
+        prog = 0;
+    }
+};
+
+// ================= Time helper =================
+// Reentrant localtime (localtime_r / localtime_s)
+static bool toLocalTm(std::time_t t, std::tm& out){
+#if defined(_WIN32)
+    return localtime_s(&out, &t) == 0;
+#else
+    return localtime_r(&t, &out) != nullptr;
+#endif
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d){
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y-399) / 400;
+    const unsigned yoe = (unsigned)(y - era*400);
+    const unsigned doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+    const unsigned doe = yoe*365 + yoe/4 - yoe/100 + doy;
+    return era*146097 + (int64_t)doe - 719468;
+}
+
+// Local wall-clock time, decomposed
+struct ClockTime {
+    int    h=0, m=0, s=0;   // 0-23, 0-59, 0-59
+    double frac=0.0;        // fraction of the current second
+};
 
-    while(!glfwWindowShouldClose(win)){
-        glfwPollEvents();
+// Local time without libc in the hot path. The UTC offset is resolved with
+// localtime_r once per hour, or at the DST transition if one falls inside
+// that hour; in between, wall time is a steady_clock delta from an anchor
+// plus integer arithmetic. When another process disciplines the shared
+// clock (see time_sync.h) the steady reading is mapped to UTC through its
+// page instead, still without a syscall. Each instance owns its cache, so
+// clocks on different threads never share state or take the libc timezone lock.
+struct LocalTimeSource {
+    std::chrono::steady_clock::time_point anchor;
+    int64_t anchorUtcNs = 0;  // system_clock at `anchor`
+    int64_t validUntil  = 0;  // UTC seconds; re-resolve at or after this
+    int64_t offset      = 0;  // local - UTC, seconds
+    bool    primed      = false;
+    bool    useShared   = true;
+    SharedClock shared;       // read-only; unmapped until a writer appears
 
-        // local time (ticking seconds, smooth hour/minute)
-        double tnow = nowSeconds();
-        std::time_t tt = (std::time_t)tnow;
+    static int64_t utcOffsetAt(std::time_t t){
         std::tm lt{};
-    #if defined(_WIN32)
-        localtime_s(&lt,&tt);
-    #else
-        lt = *std::localtime(&tt);
-    #endif
-        int    s_i = lt.tm_sec;           // tick
-        double s   = double(s_i);
-        double m   = lt.tm_min + s/60.0;  // smooth minute
-        double h   = (lt.tm_hour%12) + m/60.0; // smooth hour
+        if(!toLocalTm(t, lt)) return 0;
+        int64_t local = daysFromCivil(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday)*86400
+                      + lt.tm_hour*3600 + lt.tm_min*60 + lt.tm_sec;
+        return local - (int64_t)t;
+    }
+    void anchorSystem(){
+        using namespace std::chrono;
+        anchor      = steady_clock::now();
+        anchorUtcNs = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+        primed      = true;
+    }
+    void resolve(int64_t t){
+        offset      = utcOffsetAt((std::time_t)t);
+        validUntil  = (t/3600 + 1)*3600;
+        if(utcOffsetAt((std::time_t)validUntil) != offset){
+            // DST change inside this hour: bisect for the first second of the new offset
+            int64_t lo = t, hi = validUntil;
+            while(hi - lo > 1){
+                int64_t mid = lo + (hi - lo)/2;
+                (utcOffsetAt((std::time_t)mid) == offset ? lo : hi) = mid;
+            }
+            validUntil = hi;
+        }
+    }
+    // UTC nanoseconds since the epoch, from the monotonic clock
+    int64_t utcNs(){
+        using namespace std::chrono;
+        if(!primed) anchorSystem();
+        const steady_clock::time_point at = steady_clock::now();
+        int64_t ns;
+        const bool synced = useShared && shared.read(duration_cast<nanoseconds>(at.time_since_epoch()).count(), ns);
+        if(!synced) ns = anchorUtcNs + duration_cast<nanoseconds>(at - anchor).count();
+        if(ns/1000000000 >= validUntil){
+            if(!synced){ anchorSystem(); ns = anchorUtcNs; } // hourly: pick up system clock changes
+            resolve(ns/1000000000);
+        }
+        return ns;
+    }
+    ClockTime now(){
+        int64_t ns = utcNs();
+        return decompose(ns, offset);
+    }
+    // Wall time at a fixed UTC offset (dashboard zones)
+    static ClockTime decompose(int64_t ns, int64_t offsetSec){
+        int64_t local = ns/1000000000 + offsetSec;
+        int64_t sod   = ((local % 86400) + 86400) % 86400; // seconds of day
+        ClockTime ct;
+        ct.h = (int)(sod/3600);
+        ct.m = (int)(sod/60 % 60);
+        ct.s = (int)(sod % 60);
+        ct.frac = (double)(ns % 1000000000) * 1e-9;
+        return ct;
+    }
+};
+
+// ================= Redraw scheduling =================
+// Event-driven mode: the loop sleeps in glfwWaitEventsTimeout until the next
+// second boundary (or input/resize/expose) and only repaints when something
+// visible changed. Callbacks just mark the frame as damaged.
+static bool g_damaged = true;
+static void onFramebufferSize(GLFWwindow*, int, int){ g_damaged = true; }
+static void onWindowRefresh(GLFWwindow*){ g_damaged = true; }
+// Key presses for the complications (stopwatch), taken by the next frame
+static std::vector<int> g_keys;
+static void onKey(GLFWwindow*, int key, int, int action, int){ if(action == GLFW_PRESS) g_keys.push_back(key); }
+
+// ================= Power policy =================
+// The clock runs 24/7, so it only works as hard as what can be seen needs:
+// the configured rate (vsync sweep, --continuous) while focused, 1 Hz ticks
+// in the background, and one update a minute when no second hand is
+// visible (iconified, or a theme with a zero-length second hand). Small
+// dials also drop MSAA and take the cached mesh path. GLFW reports no
+// occlusion, so losing focus stands in for it.
+enum PowerState { PW_FULL, PW_TICK, PW_MINUTE, PW_COUNT };
+static const char* const POWER_NAMES[PW_COUNT] = { "full", "tick", "minute" };
+static const int SMALL_DIAL_PX = 160; // dial cells below this are drawn cheaply
+static bool g_focused = true, g_iconified = false;
+static void onWindowFocus(GLFWwindow*, int focused){ g_focused = focused != 0; }
+static void onWindowIconify(GLFWwindow*, int iconified){ g_iconified = iconified != 0; g_damaged = true; }
+
+// animated: --sweep or --continuous (the only modes faster than 1 Hz)
+static PowerState choosePower(bool secondsVisible, bool animated){
+    if(g_iconified || (!secondsVisible && !(g_focused && animated))) return PW_MINUTE;
+    return g_focused ? PW_FULL : PW_TICK;
+}
+
+// Window-space box around a hand at angle a on the dial placed by g (Clocks
+// UBO entry), transformed like the vertex stage. HandSpec extents bound all
+// of genHourHand/genMinuteHand/genSecondHand; hub covers the second hand's
+// disc. Padded for the antialiased fringe.
+static DamageRect handDamage(const HandSpec& h, float hub, float a, const float* g, int W, int H){
+    const float hw = std::max(0.5f*h.width, hub), tail = std::max(h.tail, hub);
+    const float corners[4][2] = { {-hw,-tail}, {hw,-tail}, {-hw,h.length}, {hw,h.length} };
+    const float c = std::cos(a), s = std::sin(a);
+    float x0 = 1e9f, y0 = 1e9f, x1 = -1e9f, y1 = -1e9f;
+    for(const auto& p : corners){
+        const float x = ((c*p[0] - s*p[1])*g[0] + g[2] + 1.0f)*0.5f*W;
+        const float y = ((s*p[0] + c*p[1])*g[1] + g[3] + 1.0f)*0.5f*H;
+        x0 = std::min(x0, x); x1 = std::max(x1, x);
+        y0 = std::min(y0, y); y1 = std::max(y1, y);
+    }
+    const int PAD = 2;
+    return { (int)std::floor(x0) - PAD, (int)std::floor(y0) - PAD, (int)std::ceil(x1) + PAD, (int)std::ceil(y1) + PAD };
+}
+
+// Window-space box around a circle on the dial placed by g (a complication).
+static DamageRect circleDamage(float cx, float cy, float r, const float* g, int W, int H){
+    const float x0 = ((cx - r)*g[0] + g[2] + 1.0f)*0.5f*W, x1 = ((cx + r)*g[0] + g[2] + 1.0f)*0.5f*W;
+    const float y0 = ((cy - r)*g[1] + g[3] + 1.0f)*0.5f*H, y1 = ((cy + r)*g[1] + g[3] + 1.0f)*0.5f*H;
+    const int PAD = 2;
+    return { (int)std::floor(x0) - PAD, (int)std::floor(y0) - PAD, (int)std::ceil(x1) + PAD, (int)std::ceil(y1) + PAD };
+}
+
+static double secondsToNextTick(const ClockTime& t){
+    return 1.0 - t.frac;
+}
+static double secondsToNextMinute(const ClockTime& t){
+    return 60.0 - t.s - t.frac;
+}
+
+// ================= Frame producer =================
+// Everything a frame needs besides GPU work (time fetch, per-zone angle
+// math, theme polling and parsing) runs on a producer thread and reaches
+// the render thread as a FramePacket through a LatestSlot. The render
+// thread only ever takes the newest packet and submits, so a slow
+// localtime or file-system stall delays the next packet, never a frame.
+
+// Lock-free single-producer/single-consumer "latest value" slot (triple
+// buffer): each side owns one buffer outright and they trade through the
+// third with a single atomic exchange. Unread packets are overwritten.
+template<class T>
+struct LatestSlot {
+    static const unsigned FRESH = 4;
+    T buf[3];
+    std::atomic<unsigned> middle{1};   // buffer index | FRESH
+    unsigned back=0, front=2;          // producer's / consumer's buffer
+
+    T& writable(){ return buf[back]; }
+    void publish(){ back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3; }
+    // Swaps in the newest packet, if one arrived since the last take.
+    bool take(){
+        if(!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    const T& latest() const { return buf[front]; }
+};
+
+struct FramePacket {
+    std::chrono::steady_clock::time_point sampled; // when the angles hold
+    int64_t  utcNs = 0;                            // ... in UTC
+    int64_t  offsets[MAX_CLOCKS] = {};             // local - UTC per dial, seconds
+    float    angles[3*MAX_CLOCKS] = {};            // hour, minute, second per dial
+    unsigned themeSeq = 0;                         // bumped whenever `theme` is new
+    Theme    theme;
+
+    // Angles at `t`. Ticking packets hold for their whole second; sweep
+    // packets advance along each hand's constant angular rate.
+    void anglesAt(std::chrono::steady_clock::time_point t, bool sweep, float* out, int n) const {
+        const double TAU = 6.28318530718;
+        const double RATE[3] = { -TAU/43200.0, -TAU/3600.0, -TAU/60.0 }; // rad/s
+        const double dt = sweep ? std::chrono::duration<double>(t - sampled).count() : 0.0;
+        for(int i=0; i<3*n; i++) out[i] = angles[i] + float(RATE[i%3]*dt);
+    }
+};
+
+struct FrameProducer {
+    static constexpr double THEME_POLL = 0.25;      // s between theme file checks
+    static constexpr double THEME_POLL_IDLE = 2.0;  // ... at PW_MINUTE
+
+    // Configuration: fixed before start()
+    std::vector<double> zones;  // UTC offsets (hours); empty = local time
+    bool sweep = false;
+    bool wakeRender = false;    // post an empty GLFW event per new packet
+    std::atomic<int> power{PW_FULL}; // set by the render thread (setPower)
+    std::atomic<int64_t> deadline{INT64_MAX}; // UTC ns; see setDeadline
 
+    LocalTimeSource time;       // producer-owned; see LocalTimeSource
+    ThemeWatcher    themeWatch;
+    Theme           theme;
+    unsigned        themeSeq = 0;
+    LatestSlot<FramePacket> slot;
+
+    std::thread thread;
+    std::mutex  lock;
+    std::condition_variable cv;
+    bool quit = false, nudged = false;
+
+    // Below PW_FULL sweep packets tick, and at PW_MINUTE the producer only
+    // wakes at minute boundaries; the render loop then waits on its events.
+    void setPower(PowerState p){
+        { std::lock_guard<std::mutex> g(lock); power = p; nudged = true; }
+        cv.notify_one();
+    }
+    // The next complication change: a packet is published when it passes,
+    // even if no hand moved.
+    void setDeadline(int64_t utcNs){
+        if(deadline.load(std::memory_order_relaxed) == utcNs) return;
+        { std::lock_guard<std::mutex> g(lock); deadline = utcNs; nudged = true; }
+        cv.notify_one();
+    }
+    // Reparses the theme file if it changed on disk.
+    bool pollTheme(){
+        if(!themeWatch.changed()) return false;
+        Theme t;
+        if(!loadTheme(themeWatch.path, t)) return false;
+        theme = t;
+        themeSeq++;
+        return true;
+    }
+    // Fills `p` for UTC time `utcNs` (sampled at steady time `at`).
+    void sample(FramePacket& p, int64_t utcNs, std::chrono::steady_clock::time_point at){
+        const double TAU = 6.28318530718;
         auto toA = [&](double f)->float { return float(-TAU*f + TAU*0.25f); };
-        float aS = toA(s/60.0);
-        float aM = toA(m/60.0);
-        float aH = toA(h/12.0);
+        const int n = zones.empty() ? 1 : (int)zones.size();
+        const int pw = power.load(std::memory_order_relaxed);
+        const bool smooth = sweep && pw == PW_FULL;
+        for(int k=0; k<n; k++){
+            int64_t off = zones.empty() ? time.offset : (int64_t)std::lround(zones[k]*3600.0);
+            ClockTime lt = LocalTimeSource::decompose(utcNs, off);
+            p.offsets[k] = off;
+            // ticking (or sweeping) seconds, smooth hour/minute; whole minutes at PW_MINUTE
+            double s = pw == PW_MINUTE ? 0.0 : double(lt.s) + (smooth ? lt.frac : 0.0);
+            double m = lt.m + s/60.0;
+            double h = (lt.h%12) + m/60.0;
+            p.angles[3*k+0] = toA(h/12.0);
+            p.angles[3*k+1] = toA(m/60.0);
+            p.angles[3*k+2] = toA(s/60.0);
+        }
+        p.sampled = at;
+        p.utcNs = utcNs;
+        if(p.themeSeq != themeSeq){ p.theme = theme; p.themeSeq = themeSeq; }
+    }
+    void run(){
+        using namespace std::chrono;
+        float last[3*MAX_CLOCKS] = {};
+        bool  first = true;
+        int64_t served = INT64_MIN; // deadline the last packet was published for
+        std::unique_lock<std::mutex> lk(lock);
+        while(!quit){
+            lk.unlock();
+            bool themed = pollTheme();
+            int64_t utc = time.utcNs();
+            const int pw = power.load(std::memory_order_relaxed);
+            FramePacket& p = slot.writable();
+            sample(p, utc, steady_clock::now());
+            const int64_t due = deadline.load(std::memory_order_relaxed);
+            const bool dueNow = utc >= due && due != served;
+            // Ticking packets only change once a second; sweep ones rebase
+            if(first || themed || dueNow || (sweep && pw == PW_FULL) || std::memcmp(p.angles, last, sizeof(last))){
+                std::memcpy(last, p.angles, sizeof(last));
+                first = false;
+                if(dueNow) served = due;
+                slot.publish();
+                if(wakeRender || pw != PW_FULL) glfwPostEmptyEvent();
+            }
+            const ClockTime t = LocalTimeSource::decompose(utc, 0); // zones are whole minutes apart
+            double wait = (pw == PW_MINUTE ? secondsToNextMinute(t) : secondsToNextTick(t)) + 0.0005;
+            if(themeWatch.path) wait = std::min(wait, pw == PW_MINUTE ? THEME_POLL_IDLE : THEME_POLL);
+            if(due > utc && due != INT64_MAX) wait = std::min(wait, (due - utc)*1e-9 + 0.0005);
+            lk.lock();
+            cv.wait_for(lk, duration<double>(wait), [&]{ return quit || nudged; });
+            nudged = false;
+        }
+    }
+    void start(){ thread = std::thread([this]{ run(); }); }
+    void stop(){
+        if(!thread.joinable()) return;
+        { std::lock_guard<std::mutex> g(lock); quit = true; }
+        cv.notify_one();
+        thread.join();
+    }
+};
+
+// ================= Frame pacing (sweep mode) =================
+// A sweeping second hand is drawn for the moment the frame will be shown:
+// the vsync period and phase are learned from when glfwSwapBuffers returns,
+// each frame targets the first vsync it can still make given the recent
+// render cost, and the loop sleeps until just before that deadline instead
+// of blocking inside the swap (so input and time are sampled late).
+struct FramePacer {
+    using Clock = std::chrono::steady_clock;
+    static constexpr double MARGIN = 0.0015;  // s of slack before the deadline
+    Clock::time_point lastSwap, workStart, target;
+    double period = 1.0/60.0;  // s; refined from swap intervals
+    double work   = 0.002;     // s from wake-up to swap call, smoothed
+    int    rejected = 0;       // consecutive intervals off the estimate
+    bool   primed = false;
+
+    static double sec(Clock::duration d){ return std::chrono::duration<double>(d).count(); }
+    static Clock::duration dur(double s){
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+    }
+    // Picks the target vsync and sleeps (handling events) until it is time
+    // to start rendering for it. Returns the target's lead over now, in ns.
+    int64_t wait(GLFWwindow* win){
+        Clock::time_point now = Clock::now();
+        if(!primed){ workStart = target = now; glfwPollEvents(); return 0; }
+        double k = std::floor(sec(now - lastSwap)/period) + 1.0;
+        target = lastSwap + dur(k*period);
+        if(target - dur(work + MARGIN) < now) target += dur(period); // too late for this one
+        Clock::time_point wake = target - dur(work + MARGIN);
+        while((now = Clock::now()) < wake && !glfwWindowShouldClose(win))
+            glfwWaitEventsTimeout(sec(wake - now));
+        now = Clock::now();
+        workStart = now;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(target - now).count();
+    }
+    // Call right before glfwSwapBuffers...
+    void submitted(){ work += 0.1*(sec(Clock::now() - workStart) - work); }
+    // ...and right after it returns: that is (close to) a vsync.
+    void swapped(){
+        Clock::time_point t = Clock::now();
+        if(primed){
+            double dt = sec(t - lastSwap);
+            if(dt < 1.5*period || ++rejected > 8){ // skip missed frames, reseed if persistent
+                if(rejected > 8) period = dt;
+                else             period += 0.05*(dt - period);
+                rejected = 0;
+            }
+        }
+        lastSwap = t;
+        primed = true;
+    }
+};
+
+// ================= Frame stats =================
+// Optional instrumentation: CPU time per loop phase (steady_clock), GPU time
+// per pass (StatPass, timed by the backend without stalling it), and
+// draw/vertex counters. Reported once per second to stderr and/or the
+// overlay; --stats-csv writes every frame. With samples on (bench mode)
+// every frame is kept for the final percentile report.
+enum StatPhase { PH_TIME, PH_SETUP, PH_SUBMIT, PH_SWAP, PH_COUNT };
 
-        int W,H; glfwGetFramebufferSize(win,&W,&H);
+DrawCounters g_draws;
+
+struct FrameStats {
+    using Clock = std::chrono::steady_clock;
+    long   frame=0;
+    Clock::time_point mark0, periodStart;
+    double cpuMs[PH_COUNT] = {};
+    double gpuMs[GP_COUNT] = {};   // from a frame the GPU has finished
+    DrawCounters counters;
+    // Period averages (what gets reported)
+    double sumCpu[PH_COUNT] = {}, sumGpu[GP_COUNT] = {};
+    long   sumDraws=0, sumVerts=0, periodFrames=0;
+    double avgCpu[PH_COUNT] = {}, avgGpu[GP_COUNT] = {}, avgDraws=0, avgVerts=0;
+    bool   print=false;
+    int    power=PW_FULL;   // PowerState of the frame, and whether it was drawn small
+    bool   small=false;
+    FILE*  csv=nullptr;
+    // Per-frame samples for report(): frame interval, CPU (excluding swap), GPU
+    bool   keepSamples=false;
+    Clock::time_point lastEnd;
+    std::vector<double> frameMs, cpuFrameMs, gpuFrameMs;
+
+    void init(bool toStderr, const char* csvPath){
+        print = toStderr;
+        if(csvPath){
+            csv = std::fopen(csvPath, "w");
+            if(!csv) std::fprintf(stderr, "[FrameStats] cannot open %s\n", csvPath);
+            else std::fprintf(csv, "frame,time_ms,setup_ms,submit_ms,swap_ms,gpu_dial_ms,gpu_numerals_ms,gpu_hands_ms,draws,verts,power\n");
+        }
+        periodStart = lastEnd = Clock::now();
+    }
+    // Keeps samples for n frames, allocated up front so the loop itself doesn't
+    void keep(int n){
+        keepSamples = true;
+        frameMs.reserve(n); cpuFrameMs.reserve(n); gpuFrameMs.reserve(n);
+    }
+    void wait(){ mark0 = Clock::now(); } // idle time before the frame isn't counted
+    void beginFrame(RenderBackend& backend){
+        backend.gpuTimes(gpuMs);
+        g_draws = DrawCounters{};
+    }
+    // Closes the phase that has been running since the previous mark
+    void mark(StatPhase ph){
+        Clock::time_point t = Clock::now();
+        cpuMs[ph] = std::chrono::duration<double, std::milli>(t - mark0).count();
+        mark0 = t;
+    }
+    // Returns true when a new set of period averages is ready.
+    bool endFrame(){
+        counters = g_draws;
+        if(csv){
+            std::fprintf(csv, "%ld,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%ld,%ld,%s%s\n", frame,
+                         cpuMs[PH_TIME], cpuMs[PH_SETUP], cpuMs[PH_SUBMIT], cpuMs[PH_SWAP],
+                         gpuMs[GP_DIAL], gpuMs[GP_NUMERALS], gpuMs[GP_HANDS], counters.draws, counters.verts,
+                         POWER_NAMES[power], small ? "+small" : "");
+        }
+        for(int i=0; i<PH_COUNT; i++) sumCpu[i] += cpuMs[i];
+        for(int i=0; i<GP_COUNT; i++) sumGpu[i] += gpuMs[i];
+        sumDraws += counters.draws; sumVerts += counters.verts;
+        periodFrames++;
+        frame++;
+
+        Clock::time_point t = Clock::now();
+        if(keepSamples){
+            frameMs.push_back(std::chrono::duration<double, std::milli>(t - lastEnd).count());
+            cpuFrameMs.push_back(cpuMs[PH_TIME] + cpuMs[PH_SETUP] + cpuMs[PH_SUBMIT]);
+            gpuFrameMs.push_back(gpuMs[GP_DIAL] + gpuMs[GP_NUMERALS] + gpuMs[GP_HANDS]);
+        }
+        lastEnd = t;
+        if(t - periodStart < std::chrono::seconds(1)) return false;
+        double n = (double)periodFrames;
+        for(int i=0; i<PH_COUNT; i++){ avgCpu[i] = sumCpu[i]/n; sumCpu[i] = 0; }
+        for(int i=0; i<GP_COUNT; i++){ avgGpu[i] = sumGpu[i]/n; sumGpu[i] = 0; }
+        avgDraws = sumDraws/n; avgVerts = sumVerts/n;
+        sumDraws = sumVerts = 0;
+        if(print){
+            std::fprintf(stderr, "[FrameStats] %ld frames | cpu ms time %.3f setup %.3f submit %.3f swap %.3f"
+                                 " | gpu ms dial %.3f numerals %.3f hands %.3f | draws %.1f verts %.0f | power %s%s\n",
+                         periodFrames, avgCpu[PH_TIME], avgCpu[PH_SETUP], avgCpu[PH_SUBMIT], avgCpu[PH_SWAP],
+                         avgGpu[GP_DIAL], avgGpu[GP_NUMERALS], avgGpu[GP_HANDS], avgDraws, avgVerts,
+                         POWER_NAMES[power], small ? " small" : "");
+        }
+        periodFrames = 0;
+        periodStart = t;
+        return true;
+    }
+    static double percentile(std::vector<double> v, double q){
+        if(v.empty()) return 0.0;
+        size_t i = std::min(v.size()-1, (size_t)(q*(v.size()-1) + 0.5));
+        std::nth_element(v.begin(), v.begin()+i, v.end());
+        return v[i];
+    }
+    static double mean(const std::vector<double>& v){
+        double t = 0.0;
+        for(double x : v) t += x;
+        return v.empty() ? 0.0 : t/v.size();
+    }
+    // Frame interval quantile, over the kept samples but the first
+    double framePercentile(double q) const {
+        return frameMs.size() < 2 ? 0.0 : percentile(std::vector<double>(frameMs.begin()+1, frameMs.end()), q);
+    }
+    // Throughput summary of the kept samples; the first frame (shader and
+    // FBO warm-up) is left out.
+    void report(int W, int H, int clocks) const {
+        if(frameMs.size() < 2) return;
+        double total = 0.0;
+        for(size_t i=1; i<frameMs.size(); i++) total += frameMs[i];
+        const size_t n = frameMs.size() - 1;
+        std::printf("[Bench] %zu frames %dx%d %d clock%s: %.1f fps | frame ms p50 %.3f p99 %.3f"
+                    " | cpu ms %.3f gpu ms %.3f | draws %.1f verts %.0f\n",
+                    n, W, H, clocks, clocks==1 ? "" : "s", 1000.0*n/total,
+                    framePercentile(0.50), framePercentile(0.99),
+                    mean(std::vector<double>(cpuFrameMs.begin()+1, cpuFrameMs.end())),
+                    mean(std::vector<double>(gpuFrameMs.begin()+1, gpuFrameMs.end())),
+                    (double)counters.draws, (double)counters.verts);
+    }
+    void destroy(){
+        if(csv) std::fclose(csv);
+        csv = nullptr;
+    }
+};
+
+// Limits a bench run must stay within (--budget KEY=MAX,...), checked
+// after the report so a regression fails the run: draws and verts of the
+// last frame, p50/p99 frame interval in ms, and operator new calls before
+// the first frame (allocs) and per frame after it (frame-allocs). The
+// allocation keys need the counting operator new, in clock2d_bench only.
+enum BudgetKey { BK_DRAWS, BK_VERTS, BK_P50, BK_P99, BK_ALLOCS, BK_FRAME_ALLOCS, BK_COUNT };
+static const char* const BUDGET_NAMES[BK_COUNT] = { "draws", "verts", "p50", "p99", "allocs", "frame-allocs" };
+
+struct Budget {
+    double max[BK_COUNT] = {};
+    bool   set[BK_COUNT] = {};
+
+    bool any() const { return std::find(set, set+BK_COUNT, true) != set+BK_COUNT; }
+    bool parse(const char* spec){
+        for(const char* p = spec; *p; ){
+            const char* end = p + std::strcspn(p, ",");
+            const char* eq  = p + std::strcspn(p, "=,");
+            int k = 0;
+            while(k < BK_COUNT && (std::strlen(BUDGET_NAMES[k]) != (size_t)(eq - p) || std::strncmp(p, BUDGET_NAMES[k], eq - p))) k++;
+            char* num = nullptr;
+            const double v = *eq == '=' ? std::strtod(eq+1, &num) : -1.0;
+            if(k == BK_COUNT || num != end || !(v >= 0.0)){
+                std::fprintf(stderr, "--budget: expected KEY=MAX,... with keys draws, verts, p50, p99, allocs, frame-allocs\n");
+                return false;
+            }
+            max[k] = v; set[k] = true;
+            p = *end ? end+1 : end;
+        }
+        return true;
+    }
+    // Prints every limit exceeded; false if any was
+    bool check(const double measured[BK_COUNT]) const {
+        bool ok = true;
+        for(int k=0; k<BK_COUNT; k++){
+            if(!set[k] || measured[k] <= max[k]) continue;
+            std::fprintf(stderr, "[Budget] %s %.3f exceeds %.3f\n", BUDGET_NAMES[k], measured[k], max[k]);
+            ok = false;
+        }
+        return ok;
+    }
+};
+
+// Top-left readout built from the digit glyphs, one row per value:
+// CPU us per frame (excluding swap), GPU us, draw calls, vertices.
+struct StatsOverlay {
+    static const int ROWS = 4, COLS = 7;
+    int  first=-1, layer=-1;
+    long shown[ROWS] = { -1, -1, -1, -1 };
+    void build(RenderList& rl){
+        first = (int)rl.records.size();
+        for(int i=0; i<ROWS*COLS; i++) rl.add(Mesh{}, makeRecord(0.75f, 0.10f, 0.10f));
+        layer = rl.cut();
+    }
+    void set(RenderList& rl, const Mesh glyphs[10], const long values[ROWS]){
+        for(int r=0; r<ROWS; r++){
+            if(values[r] == shown[r]) continue;
+            shown[r] = values[r];
+            long v = values[r] < 0 ? 0 : values[r];
+            for(int c=COLS-1; c>=0; c--){      // right-aligned, blank leading zeros
+                bool blank = (v == 0 && c != COLS-1);
+                rl.setMesh(first + r*COLS + c, blank ? Mesh{} : glyphs[v%10]);
+                v /= 10;
+            }
+        }
+        rl.syncChunks();
+    }
+    // Glyphs 14 px tall regardless of window size
+    void layout(RenderList& rl, int W, int H){
+        const float px = 14.0f;
+        float sy = 2.0f*px/H, sx = 2.0f*px/W;
+        for(int r=0; r<ROWS; r++)
+            for(int c=0; c<COLS; c++)
+                setTransform(rl.records[first + r*COLS + c], 0.0f, sx, sy,
+                             -1.0f + sx*(1.0f + 1.1f*c), 1.0f - sy*(1.0f + 1.5f*r));
+        rl.update();
+    }
+};
+
+// ================= Export (offline frame sequence) =================
+// --export renders a time range at a fixed fps into an offscreen target of
+// any size, with no visible window. The backend reads every frame back
+// (RenderBackend::readback) into submit(), which hands the pixels to a
+// worker pool for encoding; image formats write one file per frame, stream
+// formats are appended in frame order.
+
+// Frame file pattern: exactly one %d conversion (flags/width allowed), "%%" escapes.
+static bool validFramePattern(const char* p){
+    int conversions = 0;
+    for(; *p; p++){
+        if(*p != '%') continue;
+        if(p[1] == '%'){ p++; continue; }
+        do p++; while(*p == '0' || *p == '-' || (*p >= '1' && *p <= '9'));
+        if(*p != 'd') return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+struct FrameExporter : FrameSink {
+    FrameFormat format = FF_PNG;
+    const char* path = nullptr;   // frame pattern, stream file, or "-" (stdout)
+    int w=0, h=0;
+    FILE*  stream = nullptr;
+
+    struct Job { int frame; std::vector<unsigned char> rgba; };
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::vector<std::vector<unsigned char>> spare; // recycled readback copies
+    std::mutex lock, writeLock;
+    std::condition_variable queued, dequeued, streamTurn;
+    size_t maxQueued = 0;
+    int    nextWrite = 0;         // stream formats: next frame to append
+    bool   stopping = false, failed = false;
+    // Golden check: every frame is also compared against the image at
+    // golden(frame); it fails when more than goldenPercent of its pixels are
+    // off by more than goldenLevel (anti-aliasing differs between drivers)
+    const char* golden = nullptr;
+    int    goldenLevel = 16;
+    double goldenPercent = 0.1;
+    int    goldenFailed = 0;      // frames that failed, or had no readable golden
+
+    size_t frameBytes() const { return 4*(size_t)w*h; }
+
+    bool init(int W, int H, FrameFormat f, const char* out){
+        w = W; h = H; format = f; path = out;
+        if(isStreamFormat(format)){
+            if(!std::strcmp(path, "-")){
+#ifdef _WIN32
+                _setmode(_fileno(stdout), _O_BINARY);
+#endif
+                stream = stdout;
+            } else if(!(stream = std::fopen(path, "wb"))){
+                std::fprintf(stderr, "[Export] cannot open %s\n", path);
+                return false;
+            }
+        } else if(!validFramePattern(path)){
+            std::fprintf(stderr, "[Export] %s: expected one %%d for the frame number\n", path);
+            return false;
+        }
+
+        unsigned n = std::thread::hardware_concurrency();
+        n = n > 1 ? n - 1 : 1; // leave a core for the render thread
+        maxQueued = 2*n;
+        for(unsigned i=0; i<n; i++) workers.emplace_back([this]{ work(); });
+        return true;
+    }
+    // Queues a frame for the encoders (a copy: rgba is the backend's).
+    void submit(int frame, const unsigned char* rgba) override {
+        Job job{ frame, {} };
+        {
+            std::unique_lock<std::mutex> lk(lock);
+            dequeued.wait(lk, [&]{ return jobs.size() < maxQueued; }); // encoders behind: back off
+            if(!spare.empty()){ job.rgba.swap(spare.back()); spare.pop_back(); }
+        }
+        if(rgba) job.rgba.assign(rgba, rgba + frameBytes());
+        else     job.rgba.assign(frameBytes(), 0);
+        { std::lock_guard<std::mutex> g(lock); jobs.push_back(std::move(job)); }
+        queued.notify_one();
+    }
+    // Waits for every encode (after the backend's flushReadback()).
+    // Returns false if any frame failed to write.
+    bool finish(){
+        { std::lock_guard<std::mutex> g(lock); stopping = true; }
+        queued.notify_all();
+        for(std::thread& t : workers) t.join();
+        workers.clear();
+        if(stream && stream != stdout && std::fclose(stream) != 0) failed = true;
+        else if(stream == stdout && std::fflush(stdout) != 0) failed = true;
+        stream = nullptr;
+        return !failed;
+    }
+
+    bool checkGolden(const Job& job, std::vector<unsigned char>& file, std::vector<unsigned char>& image) const {
+        char name[1024];
+        std::snprintf(name, sizeof(name), golden, job.frame);
+        file.clear();
+        if(FILE* f = std::fopen(name, "rb")){
+            unsigned char buf[65536];
+            for(size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0; ) file.insert(file.end(), buf, buf+n);
+            std::fclose(f);
+        } else {
+            std::fprintf(stderr, "[Golden] frame %d: cannot read %s\n", job.frame, name);
+            return false;
+        }
+        int gw=0, gh=0;
+        const char* err = "";
+        if(!decodeImage(file, image, gw, gh, err)){
+            std::fprintf(stderr, "[Golden] frame %d: %s: %s\n", job.frame, name, err);
+            return false;
+        }
+        if(gw != w || gh != h){
+            std::fprintf(stderr, "[Golden] frame %d: %s is %dx%d, the frame %dx%d\n", job.frame, name, gw, gh, w, h);
+            return false;
+        }
+        const ImageDiff d = compareFrame(job.rgba.data(), image.data(), w, h, goldenLevel);
+        const double percent = 100.0*d.over/((double)w*h);
+        if(percent <= goldenPercent) return true;
+        std::fprintf(stderr, "[Golden] frame %d: %ld pixels (%.2f%%) differ by more than %d, max %d (%s)\n",
+                     job.frame, d.over, percent, goldenLevel, d.maxDelta, name);
+        return false;
+    }
+
+    void work(){
+        std::vector<unsigned char> encoded, file, image;
+        for(;;){
+            Job job;
+            {
+                std::unique_lock<std::mutex> lk(lock);
+                queued.wait(lk, [&]{ return stopping || !jobs.empty(); });
+                if(jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            dequeued.notify_one();
+            if(golden && !checkGolden(job, file, image)){
+                std::lock_guard<std::mutex> g(lock);
+                goldenFailed++;
+            }
+            encodeFrame(format, job.rgba.data(), w, h, encoded);
+            bool ok;
+            if(stream){
+                std::unique_lock<std::mutex> lk(writeLock);
+                streamTurn.wait(lk, [&]{ return nextWrite == job.frame; });
+                ok = std::fwrite(encoded.data(), 1, encoded.size(), stream) == encoded.size();
+                nextWrite++;
+                lk.unlock();
+                streamTurn.notify_all();
+            } else {
+                char name[1024];
+                std::snprintf(name, sizeof(name), path, job.frame);
+                FILE* f = std::fopen(name, "wb");
+                ok = f && std::fwrite(encoded.data(), 1, encoded.size(), f) == encoded.size();
+                if(f && std::fclose(f) != 0) ok = false;
+                if(!ok) std::fprintf(stderr, "[Export] cannot write %s\n", name);
+            }
+            std::lock_guard<std::mutex> g(lock);
+            if(!ok) failed = true;
+            spare.push_back(std::move(job.rgba));
+        }
+    }
+};
+
+// ================= GL backend =================
+// Layers as instanced draws: vertices pulled from the arena's buffer
+// textures, records and dial placement published through uniform buffers
+// only when their version moved. Static layers go through the DialLayer
+// cache, and --sdf swaps dials and hands for SdfDial at normal sizes.
+// Export renders into an offscreen target and reads back without stalling:
+// each frame is resolved and read into one of PBOS pixel-pack buffers
+// behind a fence, and only mapped PBOS-1 frames later, long after the copy
+// landed. GPU passes are timed with GL_TIME_ELAPSED queries alternating
+// between two sets, read back one frame late and only once available.
+struct GlBackend : RenderBackend {
+    static const int PBOS = 3;
+    GLuint prog=0, compProg=0;
+    GLuint vbo=0, tex=0;        // arena vertices; tex: RG32F buffer texture over vbo
+    GLuint ebo=0, idxTex=0;     // arena indices; idxTex: R16UI buffer texture over ebo
+    DynamicRing recordRing;     // Records UBO, the whole list in every slot
+    GLuint vao=0, clockUbo=0, chunkBuf=0, chunkTex=0;
+    GLint  uChunkBase=-1, uChunkCount=-1, uRecordStride=-1, uClockBase=-1;
+    unsigned records=0, chunks=0, clocks=0; // RenderList versions published
+    DialLayer    dial;
+    AtlasTexture atlasTex;
+    SdfDial      sdfDial;
+    bool sdf=false, small=false;
+    PartialPresent presenter;   // whole frames unless the window surface allows less
+    int  W=0, H=0;
+    bool scissored=false;
+    // Export target (offscreen, any size) and readback
+    int    exportW=0, exportH=0;
+    GLuint msFbo=0, msRbo=0;    // multisampled render target (0 if samples <= 1)
+    GLuint fbo=0, rbo=0;        // resolved target, read back from
+    GLuint pbo[PBOS] = {};
+    GLsync fence[PBOS] = {};
+    int    pending[PBOS] = { -1, -1, -1 }; // frame in flight in each PBO
+    int    next=0;
+    // Timer queries
+    bool   timed=false;
+    GLuint query[2][GP_COUNT] = {};
+    bool   issued[2][GP_COUNT] = {};
+    int    set=0, open=-1;
+    long   timedFrames=0;
+
+    void init(const GlyphAtlas& atlas, const char* const labels[12], const Theme& theme, bool analytic, bool timing){
+        sdf = analytic; timed = timing;
+        prog = makeProgram(VS_SRC, FS_SRC);
+        compProg = makeProgram(COMPOSITE_VS_SRC, COMPOSITE_FS_SRC);
+        glUseProgram(compProg);
+        glUniform1i(glGetUniformLocation(compProg,"uDial"), 0);
+        atlasTex.init(atlas);
+        AtlasTexture::bind(prog, atlas);
+
+        // Render list objects; their contents are published by the first draw
+        glGenVertexArrays(1, &vao); // attribute-less: everything is pulled
+        glBindVertexArray(vao);     // stays bound for the lifetime of the loop
+        recordRing.init(GL_UNIFORM_BUFFER, 0, MAX_RECORDS*sizeof(DrawRecord));
+        glGenBuffers(1, &chunkBuf);
+        glBindBuffer(GL_TEXTURE_BUFFER, chunkBuf);
+        glBufferData(GL_TEXTURE_BUFFER, 4*sizeof(int32_t), nullptr, GL_STATIC_DRAW);
+        glGenTextures(1, &chunkTex);
+        glBindTexture(GL_TEXTURE_BUFFER, chunkTex);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, chunkBuf);
+        glGenBuffers(1, &clockUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, clockUbo);
+        glBufferData(GL_UNIFORM_BUFFER, (MAX_CLOCKS+1)*4*sizeof(float), nullptr, GL_STATIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, 1, clockUbo);
+
+        glUseProgram(prog);
+        glUniformBlockBinding(prog, glGetUniformBlockIndex(prog, "Records"), 0);
+        glUniformBlockBinding(prog, glGetUniformBlockIndex(prog, "Clocks"),  1);
+        glUniform1i(glGetUniformLocation(prog, "uVerts"),  1);
+        glUniform1i(glGetUniformLocation(prog, "uChunks"), 2);
+        glUniform1i(glGetUniformLocation(prog, "uIndices"), 3);
+        uChunkBase    = glGetUniformLocation(prog, "uChunkBase");
+        uChunkCount   = glGetUniformLocation(prog, "uChunkCount");
+        uRecordStride = glGetUniformLocation(prog, "uRecordStride");
+        uClockBase    = glGetUniformLocation(prog, "uClockBase");
+        glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_BUFFER, chunkTex);
+        glActiveTexture(GL_TEXTURE0);
+
+        if(sdf) sdfDial.init(theme, atlas, labels);
+        if(timed) glGenQueries(2*GP_COUNT, &query[0][0]);
+
+        if(sdf) glDisable(GL_MULTISAMPLE);
+        else    glEnable(GL_MULTISAMPLE);
+        // Glyphs blend by coverage; everything else writes alpha 1. Destination
+        // alpha stays 1 so the cached dial composites and reads back opaque.
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    // Frames go to a W x H offscreen target instead of the window.
+    bool initExport(int Wx, int Hx, int samples){
+        exportW = Wx; exportH = Hx;
+        GLint maxS=0; glGetIntegerv(GL_MAX_SAMPLES, &maxS);
+        if(samples > maxS) samples = maxS;
+        bool ok = true;
+        if(samples > 1){
+            glGenRenderbuffers(1, &msRbo);
+            glBindRenderbuffer(GL_RENDERBUFFER, msRbo);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, exportW, exportH);
+            glGenFramebuffers(1, &msFbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msRbo);
+            ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+        glGenRenderbuffers(1, &rbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, 0, GL_RGBA8, exportW, exportH);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo);
+        ok = ok && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if(!ok){ std::fprintf(stderr, "[Export] %dx%d target incomplete\n", exportW, exportH); return false; }
+
+        glGenBuffers(PBOS, pbo);
+        for(GLuint b : pbo){
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, b);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes(), nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        g_targetFbo = msFbo ? msFbo : fbo;
+        return true;
+    }
+    size_t frameBytes() const { return 4*(size_t)exportW*exportH; }
+
+    // ---- Geometry ----
+    void uploadGeometry(const float* v, int nv, const uint16_t* idx, int ni, int totalV, int totalI) override {
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_TEXTURE_BUFFER, vbo);
+        glBufferData(GL_TEXTURE_BUFFER, totalV*2*sizeof(float), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, nv*2*sizeof(float), v);
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_BUFFER, tex);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, vbo);
+
+        glGenBuffers(1, &ebo);
+        glBindBuffer(GL_TEXTURE_BUFFER, ebo);
+        glBufferData(GL_TEXTURE_BUFFER, totalI*sizeof(uint16_t), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, ni*sizeof(uint16_t), idx);
+        glGenTextures(1, &idxTex);
+        glBindTexture(GL_TEXTURE_BUFFER, idxTex);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, ebo);
+
+        glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_BUFFER, tex);
+        glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_BUFFER, idxTex);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    bool mapGeometry(int vertex, int nv, int index, int ni, float*& v, uint16_t*& idx) override {
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        glBindBuffer(GL_TEXTURE_BUFFER, vbo);
+        v = (float*)glMapBufferRange(GL_TEXTURE_BUFFER, vertex*2*sizeof(float), nv*2*sizeof(float), access);
+        glBindBuffer(GL_TEXTURE_BUFFER, ebo);
+        idx = (uint16_t*)glMapBufferRange(GL_TEXTURE_BUFFER, index*sizeof(uint16_t), ni*sizeof(uint16_t), access);
+        if(!v || !idx){
+            std::fprintf(stderr, "[GeometryArena] glMapBufferRange failed\n");
+            unmapGeometry();
+            return false;
+        }
+        return true;
+    }
+    bool unmapGeometry() override {
+        GLint mapped = 0;
+        bool ok = true;
+        for(GLuint b : { vbo, ebo }){
+            glBindBuffer(GL_TEXTURE_BUFFER, b);
+            glGetBufferParameteriv(GL_TEXTURE_BUFFER, GL_BUFFER_MAPPED, &mapped);
+            if(mapped && !glUnmapBuffer(GL_TEXTURE_BUFFER)) ok = false;
+        }
+        return ok;
+    }
+
+    // ---- State ----
+    void setTheme(const Theme& t) override { if(sdf) sdfDial.setTheme(t); }
+    void setSmall(bool s) override {
+        small = s;
+        if(!sdf){ if(small) glDisable(GL_MULTISAMPLE); else glEnable(GL_MULTISAMPLE); }
+    }
+    bool analyticDial() const override { return sdf && !small; }
+    void drawAnalyticDial(const float* angles, int n, int cols, int rows) override {
+        sdfDial.draw(W, H, angles, n, cols, rows);
+    }
+
+    // ---- Frame ----
+    void beginFrame(int Wf, int Hf, const DamageRect& damage, const float bg[3]) override {
+        W = Wf; H = Hf;
+        const DamageRect redraw = presenter.repaint(damage, W, H);
+        scissored = redraw.x1 - redraw.x0 < W || redraw.y1 - redraw.y0 < H;
+        glBindFramebuffer(GL_FRAMEBUFFER, g_targetFbo);
         glViewport(0,0,W,H);
+        if(scissored){
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(redraw.x0, redraw.y0, redraw.x1 - redraw.x0, redraw.y1 - redraw.y0);
+        }
+        glClearColor(bg[0], bg[1], bg[2], 1.0f); // the dial cache clears to it too
         glClear(GL_COLOR_BUFFER_BIT);
-
+    }
+    // Cached: redrawn on resize or when the layers changed, composited with one draw
+    void drawStatic(const RenderList& rl, const int* layers, int count, int n, bool dirty) override {
+        if((dial.resize(W,H, small ? 0 : 4) || dirty) && dial.ok){
+            dial.begin();
+            beginPass(GP_DIAL);
+            drawLayer(rl, layers[0], n, 0, 0);
+            beginPass(GP_NUMERALS);
+            for(int i=1; i<count; i++) drawLayer(rl, layers[i], n, 0, 0);
+            endPass();
+            dial.end();
+            glViewport(0,0,W,H);
+        }
+        beginPass(GP_DIAL);
+        if(dial.ok) dial.composite(compProg);
+        else {
+            drawLayer(rl, layers[0], n, 0, 0);
+            beginPass(GP_NUMERALS);
+            for(int i=1; i<count; i++) drawLayer(rl, layers[i], n, 0, 0);
+        }
+    }
+    // One call draws the layer for n dials.
+    void drawLayer(const RenderList& rl, int layer, int n, int recordStride, int clockBase) override {
+        const RenderList::Layer& l = rl.layers[layer];
+        if(!l.chunkCount) return;
+        publish(rl);
         glUseProgram(prog);
+        glUniform1i(uChunkBase, l.firstChunk);
+        glUniform1i(uChunkCount, l.chunkCount);
+        glUniform1i(uRecordStride, recordStride);
+        glUniform1i(uClockBase, clockBase);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, CHUNK_VERTS, l.chunkCount*n);
+        g_draws.draws++;
+        g_draws.verts += (long)CHUNK_VERTS*l.chunkCount*n;
+    }
+    // What moved in the list since the last draw. Records go as a whole:
+    // every ring slot holds the full list (non-persistent slots are mapped
+    // invalidated).
+    void publish(const RenderList& rl){
+        if(rl.chunksVersion != chunks){
+            glBindBuffer(GL_TEXTURE_BUFFER, chunkBuf);
+            glBufferData(GL_TEXTURE_BUFFER, rl.chunks.size()*sizeof(int32_t), rl.chunks.data(), GL_STATIC_DRAW);
+            chunks = rl.chunksVersion;
+        }
+        if(rl.recordsVersion != records){
+            if(void* p = recordRing.acquire()){
+                std::memcpy(p, rl.records.data(), rl.records.size()*sizeof(DrawRecord));
+                recordRing.commit();
+            }
+            records = rl.recordsVersion;
+        }
+        if(rl.clocksVersion != clocks){
+            glBindBuffer(GL_UNIFORM_BUFFER, clockUbo);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(rl.clockXf), rl.clockXf);
+            clocks = rl.clocksVersion;
+        }
+    }
+    void endFrame() override {
+        endPass();
+        if(scissored) glDisable(GL_SCISSOR_TEST);
+    }
+    void present(GLFWwindow* win, const DamageRect& damage, int Wf, int Hf) override {
+        presenter.present(win, damage, Wf, Hf);
+    }
+    // Call after the frame's draws, in place of the swap.
+    void readback(FrameSink& sink, int frame) override {
+        if(msFbo){
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, msFbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+            glBlitFramebuffer(0,0,exportW,exportH, 0,0,exportW,exportH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        const int i = next;
+        next = (next + 1) % PBOS;
+        if(pending[i] >= 0) collect(sink, i);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[i]);
+        glReadPixels(0, 0, exportW, exportH, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // async into the PBO
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        fence[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pending[i] = frame;
+        glBindFramebuffer(GL_FRAMEBUFFER, g_targetFbo);
+    }
+    void flushReadback(FrameSink& sink) override {
+        for(int k=0; k<PBOS; k++){
+            int i = (next + k) % PBOS;
+            if(pending[i] >= 0) collect(sink, i);
+        }
+    }
+    // Maps PBO i (its copy is normally long done) and hands the frame over.
+    void collect(FrameSink& sink, int i){
+        GLenum r;
+        do r = glClientWaitSync(fence[i], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+        while(r == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence[i]);
+        fence[i] = nullptr;
+
+        const int frame = pending[i];
+        pending[i] = -1;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[i]);
+        if(const void* src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes(), GL_MAP_READ_BIT)){
+            sink.submit(frame, (const unsigned char*)src);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            std::fprintf(stderr, "[Export] frame %d: readback map failed\n", frame);
+            sink.submit(frame, nullptr); // keep the stream's frame count
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // ---- Timing ----
+    void beginPass(StatPass p) override {
+        if(!timed) return;
+        if(open >= 0) endPass();      // time-elapsed queries cannot nest
+        glBeginQuery(GL_TIME_ELAPSED, query[set][p]);
+        issued[set][p] = true;
+        open = p;
+    }
+    void endPass() override {
+        if(open < 0) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        open = -1;
+    }
+    // Reads the set issued two frames ago and starts reusing it; a result
+    // still pending leaves ms[p] as it was.
+    void gpuTimes(double ms[GP_COUNT]) override {
+        set = (int)(timedFrames++ & 1);
+        for(int p=0; p<GP_COUNT; p++){
+            GLuint ready = 0;
+            if(issued[set][p]) glGetQueryObjectuiv(query[set][p], GL_QUERY_RESULT_AVAILABLE, &ready);
+            if(!issued[set][p]) ms[p] = 0.0;
+            else if(ready){
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(query[set][p], GL_QUERY_RESULT, &ns);
+                ms[p] = ns*1e-6;
+            }
+            issued[set][p] = false;
+        }
+    }
+
+    void destroy() override {
+        if(query[0][0]) glDeleteQueries(2*GP_COUNT, &query[0][0]);
+        query[0][0] = 0;
+        for(GLsync& f : fence) if(f){ glDeleteSync(f); f = nullptr; }
+        if(pbo[0]) glDeleteBuffers(PBOS, pbo);
+        if(fbo)    glDeleteFramebuffers(1, &fbo);
+        if(rbo)    glDeleteRenderbuffers(1, &rbo);
+        if(msFbo)  glDeleteFramebuffers(1, &msFbo);
+        if(msRbo)  glDeleteRenderbuffers(1, &msRbo);
+        fbo = rbo = msFbo = msRbo = 0;
+        for(GLuint& b : pbo) b = 0;
+        g_targetFbo = 0;
+        sdfDial.destroy();
+        atlasTex.destroy();
+        dial.destroy();
+        if(chunkTex) glDeleteTextures(1, &chunkTex);
+        if(chunkBuf) glDeleteBuffers(1, &chunkBuf);
+        if(clockUbo) glDeleteBuffers(1, &clockUbo);
+        recordRing.destroy();
+        if(vao)      glDeleteVertexArrays(1, &vao);
+        chunkTex = chunkBuf = clockUbo = vao = 0;
+        if(idxTex) glDeleteTextures(1, &idxTex);
+        if(ebo)    glDeleteBuffers(1, &ebo);
+        if(tex)    glDeleteTextures(1, &tex);
+        if(vbo)    glDeleteBuffers(1, &vbo);
+        idxTex = ebo = tex = vbo = 0;
+        if(compProg) glDeleteProgram(compProg);
+        if(prog)     glDeleteProgram(prog);
+        prog = compProg = 0;
+    }
+};
+
+// ================= Allocation count =================
+// clock2d_bench counts operator new calls for the allocation budgets: every
+// replaceable form (plain, array, nothrow, aligned) goes through allocate(),
+// and every delete through release(). That includes a C++ driver's own
+// (Mesa compiles shaders with it, so GL startup counts run higher than
+// software); plain malloc is not seen.
+#ifdef CLOCK2D_BENCH
+static std::atomic<long> g_allocs{0};
+
+// Null on failure; alignments malloc already meets take the malloc path
+static void* allocate(size_t n, size_t align){
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if(!n) n = 1;
+    if(align <= alignof(std::max_align_t)) return std::malloc(n);
+#ifdef _WIN32
+    return _aligned_malloc(n, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align, n) == 0 ? p : nullptr;
+#endif
+}
+static void release(void* p, size_t align){
+#ifdef _WIN32
+    if(align > alignof(std::max_align_t)){ _aligned_free(p); return; }
+#endif
+    (void)align;
+    std::free(p);
+}
+static void* allocateOrThrow(size_t n, size_t align){
+    if(void* p = allocate(n, align)) return p;
+    throw std::bad_alloc();
+}
+static const size_t PLAIN = alignof(std::max_align_t);
+
+void* operator new  (size_t n){ return allocateOrThrow(n, PLAIN); }
+void* operator new[](size_t n){ return allocateOrThrow(n, PLAIN); }
+void* operator new  (size_t n, const std::nothrow_t&) noexcept { return allocate(n, PLAIN); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return allocate(n, PLAIN); }
+void* operator new  (size_t n, std::align_val_t a){ return allocateOrThrow(n, (size_t)a); }
+void* operator new[](size_t n, std::align_val_t a){ return allocateOrThrow(n, (size_t)a); }
+void* operator new  (size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return allocate(n, (size_t)a); }
+void* operator new[](size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return allocate(n, (size_t)a); }
+
+void operator delete  (void* p) noexcept { release(p, PLAIN); }
+void operator delete[](void* p) noexcept { release(p, PLAIN); }
+void operator delete  (void* p, size_t) noexcept { release(p, PLAIN); }
+void operator delete[](void* p, size_t) noexcept { release(p, PLAIN); }
+void operator delete  (void* p, const std::nothrow_t&) noexcept { release(p, PLAIN); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p, PLAIN); }
+void operator delete  (void* p, std::align_val_t a) noexcept { release(p, (size_t)a); }
+void operator delete[](void* p, std::align_val_t a) noexcept { release(p, (size_t)a); }
+void operator delete  (void* p, size_t, std::align_val_t a) noexcept { release(p, (size_t)a); }
+void operator delete[](void* p, size_t, std::align_val_t a) noexcept { release(p, (size_t)a); }
+void operator delete  (void* p, std::align_val_t a, const std::nothrow_t&) noexcept { release(p, (size_t)a); }
+void operator delete[](void* p, std::align_val_t a, const std::nothrow_t&) noexcept { release(p, (size_t)a); }
+#endif
+
+// ================= Main =================
+// clock2d_bench is this file built with CLOCK2D_BENCH: bench mode is on by
+// default there. Bench mode renders a fixed number of frames to a hidden
+// window with swap interval 0 and a synthetic clock (one second per frame,
+// so every frame moves the hands), then prints a throughput report.
+// --golden and --budget runs exit 1 on any failure; tests/CMakeLists.txt
+// runs both once per backend under CTest.
+#ifdef CLOCK2D_BENCH
+static const int DEFAULT_BENCH_FRAMES = 1000;
+#else
+static const int DEFAULT_BENCH_FRAMES = 0;
+#endif
+
+int main(int argc, char** argv){
+    bool continuous = false; // --continuous: old poll + redraw every vsync
+    bool sdf        = false; // --sdf: analytic dial, no MSAA
+    bool stats      = false; // --stats: per-second frame timing on stderr
+    bool overlay    = false; // --overlay: frame timing drawn on screen
+    bool sweep      = false; // --sweep: smooth second hand, vsync-paced
+    bool soft       = false; // --software: CPU rasterizer, no GL (export/bench only)
+    const char* statsCsv = nullptr; // --stats-csv FILE: per-frame timing
+    const char* themePath = nullptr; // --theme FILE: colors/dimensions, hot-reloaded
+    const char* fontPath = nullptr;  // --font FILE: TrueType outlines for the dial text
+    const char* numeralArg = nullptr; // --numerals arabic|roman|"L1,L2,...,L12"
+    const char* complicationArg = nullptr; // --complications KIND[@SLOT],... (see complications.h)
+    int  benchFrames = DEFAULT_BENCH_FRAMES; // --bench N: headless run of N frames
+    int  winW = 800, winH = 800;             // --size WxH
+    int  clockCount = 0;                     // --clocks N: dashboard of N dials
+    std::vector<double> zones; // --zones 0,5.5,-8: dashboard of UTC offsets (hours)
+    const char* exportPath = nullptr;   // --export PATH: offline render (see FrameExporter)
+    const char* exportFormat = nullptr; // --export-format png|ppm|rgba|yuv
+    const char* exportStart = nullptr;  // --export-start [YYYY-MM-DDT]HH:MM[:SS], local (UTC with --zones)
+    double exportDuration = 10.0;       // --export-duration SEC
+    double exportFps = 30.0;            // --export-fps N
+    const char* golden = nullptr;       // --golden PATTERN: compare exported frames (see FrameExporter)
+    const char* goldenTolerance = nullptr; // --golden-tolerance LEVEL[,PERCENT]
+    const char* budgetArg = nullptr;    // --budget KEY=MAX,...: bench limits (see Budget)
+    const char* timeSync = nullptr;     // --time-sync HOST[:PORT]: discipline the shared clock (SNTP)
+    const char* timeServe = nullptr;    // --time-serve [ADDR:]PORT: answer SNTP from this clock
+    bool timeLocal = false;             // --time-local: ignore the shared clock
+    for(int i=1;i<argc;i++){
+        if(!std::strcmp(argv[i],"--continuous")) continuous = true;
+        if(!std::strcmp(argv[i],"--sdf"))        sdf = true;
+        if(!std::strcmp(argv[i],"--stats"))      stats = true;
+        if(!std::strcmp(argv[i],"--overlay"))    overlay = true;
+        if(!std::strcmp(argv[i],"--sweep"))      sweep = true;
+        if(!std::strcmp(argv[i],"--software"))   soft = true;
+        if(!std::strcmp(argv[i],"--stats-csv") && i+1<argc) statsCsv = argv[++i];
+        if(!std::strcmp(argv[i],"--theme")  && i+1<argc) themePath = argv[++i];
+        if(!std::strcmp(argv[i],"--font")   && i+1<argc) fontPath = argv[++i];
+        if(!std::strcmp(argv[i],"--numerals") && i+1<argc) numeralArg = argv[++i];
+        if(!std::strcmp(argv[i],"--complications") && i+1<argc) complicationArg = argv[++i];
+        if(!std::strcmp(argv[i],"--export") && i+1<argc) exportPath = argv[++i];
+        if(!std::strcmp(argv[i],"--export-format")   && i+1<argc) exportFormat = argv[++i];
+        if(!std::strcmp(argv[i],"--export-start")    && i+1<argc) exportStart = argv[++i];
+        if(!std::strcmp(argv[i],"--export-duration") && i+1<argc) exportDuration = std::atof(argv[++i]);
+        if(!std::strcmp(argv[i],"--export-fps")      && i+1<argc) exportFps = std::atof(argv[++i]);
+        if(!std::strcmp(argv[i],"--golden")           && i+1<argc) golden = argv[++i];
+        if(!std::strcmp(argv[i],"--golden-tolerance") && i+1<argc) goldenTolerance = argv[++i];
+        if(!std::strcmp(argv[i],"--budget")           && i+1<argc) budgetArg = argv[++i];
+        if(!std::strcmp(argv[i],"--time-local"))         timeLocal = true;
+        if(!std::strcmp(argv[i],"--time-sync")  && i+1<argc) timeSync = argv[++i];
+        if(!std::strcmp(argv[i],"--time-serve") && i+1<argc) timeServe = argv[++i];
+        if(!std::strcmp(argv[i],"--bench")  && i+1<argc) benchFrames = std::atoi(argv[++i]);
+        if(!std::strcmp(argv[i],"--clocks") && i+1<argc) clockCount = std::atoi(argv[++i]);
+        if(!std::strcmp(argv[i],"--size")   && i+1<argc){
+            if(std::sscanf(argv[++i], "%dx%d", &winW, &winH) != 2 || winW <= 0 || winH <= 0){
+                std::fprintf(stderr, "--size: expected WxH\n");
+                winW = winH = 800;
+            }
+        }
+        if(!std::strcmp(argv[i],"--zones") && i+1<argc){
+            // Comma-separated hour offsets; a malformed list is dropped whole
+            zones.clear();
+            for(const char* p = argv[++i]; ; p++){
+                char* end = nullptr;
+                const double hours = std::strtod(p, &end);
+                if(end==p || (*end && *end!=',')){
+                    std::fprintf(stderr, "--zones: expected HOURS[,HOURS...], e.g. 0,-5,5.5\n");
+                    zones.clear();
+                    break;
+                }
+                zones.push_back(hours);
+                if(!*end) break;
+                p = end;
+            }
+        }
+    }
+    // --clocks without --zones: one dial per hour offset, wrapping at 24
+    for(int k=(int)zones.size(); k<clockCount && k<MAX_CLOCKS; k++) zones.push_back(k % 24);
+    if((int)zones.size() > MAX_CLOCKS){
+        std::fprintf(stderr, "--zones: at most %d clocks\n", MAX_CLOCKS);
+        zones.resize(MAX_CLOCKS);
+    }
+
+    // Numeral labels: a style, or twelve comma-separated strings for 1..12
+    const char* const* labels = ARABIC_NUMERALS;
+    std::vector<char> labelText;
+    const char* customLabels[12] = {};
+    if(numeralArg && !std::strcmp(numeralArg, "roman")) labels = ROMAN_NUMERALS;
+    else if(numeralArg && std::strcmp(numeralArg, "arabic")){
+        labelText.assign(numeralArg, numeralArg + std::strlen(numeralArg) + 1);
+        int n = 0;
+        char* p = labelText.data();
+        for(; p && n < 12; n++){
+            customLabels[n] = p;
+            if((p = std::strchr(p, ','))) *p++ = 0;
+        }
+        bool ok = n == 12 && !p;
+        for(int k=0; k<n && ok; k++){
+            int glyphs = 0;
+            for(const char* q = customLabels[k]; *q; glyphs++) decodeUtf8(q);
+            ok = glyphs <= MAX_NUMERAL_GLYPHS;
+        }
+        if(!ok){
+            std::fprintf(stderr, "--numerals: expected arabic, roman or 12 comma-separated labels of up to %d characters\n",
+                         MAX_NUMERAL_GLYPHS);
+            return 1;
+        }
+        labels = customLabels;
+    }
+
+    // Complications: the analytic dial draws the hands itself, so there is
+    // no layer to slot them under
+    ComplicationSet comps;
+    if(complicationArg && !comps.parse(complicationArg)) return 1;
+    if(sdf && !comps.items.empty()){
+        std::fprintf(stderr, "--sdf: not supported with --complications, ignored\n");
+        sdf = false;
+    }
+
+    // Export: image sequences default to PNG, stdout to raw RGBA
+    const bool exporting = exportPath != nullptr;
+    FrameFormat exportFmt = std::strcmp(exportPath ? exportPath : "", "-") ? FF_PNG : FF_RGBA;
+    int exportStartSec = -1;   // seconds of day, -1 = now
+    int64_t exportStartDay = -1; // days since 1970, -1 = today
+    int exportFrames = 0;
+    int goldenLevel = 16;
+    double goldenPercent = 0.1;
+    if(exporting){
+        if(exportFormat && !parseFrameFormat(exportFormat, exportFmt)){
+            std::fprintf(stderr, "--export-format: expected png, ppm, rgba or yuv\n");
+            return 1;
+        }
+        // A date makes the export reproducible (golden images); add --zones 0
+        // to take the local time zone out of it too
+        int hh=0, mm=0, ss=0, y=0, mo=0, d=0, n=0;
+        if(exportStart){
+            const char* t = exportStart;
+            if(std::sscanf(t, "%d-%d-%dT%n", &y, &mo, &d, &n) == 3 && n > 0){
+                if(mo<1 || mo>12 || d<1 || d>31) n = -1;
+                else exportStartDay = daysFromCivil(y, (unsigned)mo, (unsigned)d);
+                t += n > 0 ? n : 0;
+            }
+            if(n < 0 || std::sscanf(t, "%d:%d:%d", &hh, &mm, &ss) < 2 || hh<0 || hh>23 || mm<0 || mm>59 || ss<0 || ss>59){
+                std::fprintf(stderr, "--export-start: expected [YYYY-MM-DDT]HH:MM[:SS]\n");
+                return 1;
+            }
+            exportStartSec = hh*3600 + mm*60 + ss;
+        }
+        if(goldenTolerance && (std::sscanf(goldenTolerance, "%d,%lf", &goldenLevel, &goldenPercent) < 1 ||
+                               goldenLevel < 0 || goldenLevel > 255 || !(goldenPercent >= 0.0))){
+            std::fprintf(stderr, "--golden-tolerance: expected LEVEL[,PERCENT], LEVEL 0-255\n");
+            return 1;
+        }
+        if(golden && !validFramePattern(golden)){
+            std::fprintf(stderr, "--golden: %s: expected one %%d for the frame number\n", golden);
+            return 1;
+        }
+        if(!(exportFps > 0.0) || !(exportDuration > 0.0)){
+            std::fprintf(stderr, "--export-fps and --export-duration must be positive\n");
+            return 1;
+        }
+        exportFrames = std::max(1, (int)std::lround(exportDuration*exportFps));
+    }
+
+    // Dashboard grid: one dial per zone, or a single local-time dial
+    const int nClocks = zones.empty() ? 1 : (int)zones.size();
+    const int cols = (int)std::ceil(std::sqrt((double)nClocks));
+    const int rows = (nClocks + cols - 1)/cols;
+
+    // Text: one atlas for every string the dial can show, cached across runs
+    // (GL-free, so the record budget below is known before any window)
+    Font font;
+    if(fontPath && !font.loadTrueType(fontPath)) std::fprintf(stderr, "[Font] using the built-in font\n");
+    std::vector<uint32_t> charset;
+    addCodepoints(charset, TEXT_CHARSET);
+    for(int n=0; n<12; n++) addCodepoints(charset, labels[n]);
+    GlyphAtlas atlas;
+    loadGlyphAtlas(atlas, font, charset);
+    comps.declare(atlas, nClocks);
+
+    // Record budget: the dial, the numerals, three hands per dial and the
+    // overlay must fit in one render list; complications take what is left
+    // and are dropped, not the dials, when it is not enough
+    {
+        int numeralRecords = 0;
+        forEachNumeralGlyph(atlas, labels, 0.0f, 1.0f, [&](int, int, float, float, float){ numeralRecords++; });
+        const int overlayRecords = overlay ? StatsOverlay::ROWS*StatsOverlay::COLS : 0;
+        const int required = DIAL_RECORDS + numeralRecords + 3*nClocks + overlayRecords;
+        if(required > MAX_RECORDS){
+            std::fprintf(stderr, "[RenderList] %d dials need %d of %d records (3 per dial, %d for the numerals, %d for the overlay);"
+                                 " use fewer dials or shorter numerals\n",
+                         nClocks, required, MAX_RECORDS, numeralRecords, overlayRecords);
+            return 1;
+        }
+        if((int)comps.face.size() + comps.liveCount*nClocks > MAX_RECORDS - required){
+            std::fprintf(stderr, "[Complications] no room for them on %d dials, dropped\n", nClocks);
+            comps = ComplicationSet{};
+            comps.declare(atlas, nClocks);
+        }
+    }
+
+    const bool bench = benchFrames > 0 && !exporting;
+    const bool offline = bench || exporting; // synthetic time, no vsync, hidden window
+    if(golden && !exporting){
+        std::fprintf(stderr, "--golden: needs --export\n");
+        return 1;
+    }
+    Budget budget;
+    if(budgetArg && !budget.parse(budgetArg)) return 1;
+    if(budget.any() && !bench){
+        std::fprintf(stderr, "--budget: needs a bench run\n");
+        return 1;
+    }
+#ifndef CLOCK2D_BENCH
+    if(budget.set[BK_ALLOCS] || budget.set[BK_FRAME_ALLOCS]){
+        std::fprintf(stderr, "--budget: allocations are only counted by clock2d_bench\n");
+        return 1;
+    }
+#endif
+
+    // Shared wall time (time_sync.h); offline runs keep off the network
+    TimeDiscipline discipline;
+    TimeServer timeServer;
+    discipline.verbose = stats;
+    if(!offline && timeSync && !discipline.start(timeSync)) return 1;
+    if(!offline && timeServe && !timeServer.start(timeServe)) return 1;
+
+    // Without a GL context, offline runs fall back to the software rasterizer
+    GLFWwindow* win = nullptr;
+    if(!soft){
+        if(glfwInit()){
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,2);
+            glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
+            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT,GL_TRUE);
+            glfwWindowHint(GLFW_SAMPLES, sdf ? 0 : 4);
+            if(offline) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef CLOCK2D_EGL_DAMAGE
+            // EGL window surfaces report buffer age and take damage (PartialPresent)
+            if(!offline) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+            // Export renders offscreen at --size; its window only carries the context
+            win = exporting ? glfwCreateWindow(64,64,"Analog Clock",nullptr,nullptr)
+                            : glfwCreateWindow(winW,winH,"Analog Clock",nullptr,nullptr);
+#ifdef CLOCK2D_EGL_DAMAGE
+            if(!win && !offline){
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+                win = glfwCreateWindow(winW,winH,"Analog Clock",nullptr,nullptr);
+            }
+#endif
+            if(win){
+                glfwMakeContextCurrent(win);
+                if(!glLoadFunctions()){ glfwDestroyWindow(win); win = nullptr; }
+            }
+            if(!win) glfwTerminate();
+        } else std::fprintf(stderr,"GLFW init failed\n");
+        if(!win && !offline) return 1;
+        if(!win) std::fprintf(stderr, "[Main] no GL context, using the software rasterizer\n");
+        soft = !win;
+    } else if(!offline){
+        std::fprintf(stderr, "--software: needs --export or --bench (there is no window to show)\n");
+        return 1;
+    }
+    if(soft && sdf){
+        std::fprintf(stderr, "--sdf: not supported by the software rasterizer, ignored\n");
+        sdf = false;
+    }
+    if(win) glfwSwapInterval(offline ? 0 : 1);
+
+    // What the backend currently shows: the stock (baked) clock
+    Theme applied;
+    const Theme& T = applied;
+    const bool measure = stats || overlay || statsCsv || bench;
+
+    // ---- Renderer: the one place the GL and software paths part ----
+    std::unique_ptr<RenderBackend> backend;
+    if(win){
+        GlBackend* gl = new GlBackend;
+        backend.reset(gl);
+        gl->init(atlas, labels, T, sdf, measure);
+        if(exporting && !gl->initExport(winW, winH, sdf ? 0 : 4)){
+            backend->destroy();
+            glfwDestroyWindow(win);
+            glfwTerminate();
+            return 1;
+        }
+        if(!offline && gl->presenter.init(win) && stats)
+            std::fprintf(stderr, "[Present] partial redraw %s, damage hints %s\n",
+                         gl->presenter.scissor ? "on" : "off", gl->presenter.hinted ? "on" : "off");
+    } else {
+        SoftBackend* sw = new SoftBackend;
+        backend.reset(sw);
+        sw->init(winW, winH, atlas);
+    }
+
+    FrameExporter exporter;
+    exporter.golden = golden;
+    exporter.goldenLevel = goldenLevel;
+    exporter.goldenPercent = goldenPercent;
+    if(exporting && !exporter.init(winW, winH, exportFmt, exportPath)){
+        backend->destroy();
+        if(win){ glfwDestroyWindow(win); glfwTerminate(); }
+        return 1;
+    }
+    if(win){
+        glfwSetFramebufferSizeCallback(win, onFramebufferSize);
+        glfwSetWindowRefreshCallback(win, onWindowRefresh);
+        glfwSetWindowFocusCallback(win, onWindowFocus);
+        glfwSetWindowIconifyCallback(win, onWindowIconify);
+        if(!comps.items.empty()) glfwSetKeyCallback(win, onKey);
+        g_focused = glfwGetWindowAttrib(win, GLFW_FOCUSED) != 0;
+    }
+
+    const int compVerts = (int)comps.geometry.v.size()/2, compIdx = (int)comps.geometry.idx.size();
+
+    // Geometry: baked at compile time, uploaded straight from .rodata. The
+    // tail holds what is rebuilt at runtime: LOD circles, themed ticks/hands,
+    // and the complications' meshes, declared once at startup.
+    const ClockMeshes& M = BAKED_CLOCK.meshes;
+    GeometryArena arena;
+    arena.upload(*backend, BAKED_CLOCK.geo.v.data(), BAKED_CLOCK.geo.nv,
+                 BAKED_CLOCK.geo.idx.data(), BAKED_CLOCK.geo.ni,
+                 DialLod::maxVerts()   + THEME_TICKS_SIZE.nv + THEME_HANDS_SIZE.nv + compVerts,
+                 DialLod::maxIndices() + THEME_TICKS_SIZE.ni + THEME_HANDS_SIZE.ni + compIdx);
+    DialLod lod; // circles are filled in on the first frame
+    lod.init(arena);
+    const DynRegion tickRegion = arena.reserve(THEME_TICKS_SIZE.nv, THEME_TICKS_SIZE.ni);
+    const DynRegion handRegion = arena.reserve(THEME_HANDS_SIZE.nv, THEME_HANDS_SIZE.ni);
+    const DynRegion compRegion = arena.reserve(compVerts, compIdx);
+    SpanGeometry compSpan;
+    if(compVerts && arena.mapDynamic(compRegion, compVerts, compIdx, compSpan)){
+        std::memcpy(compSpan.v, comps.geometry.v.data(), comps.geometry.v.size()*sizeof(float));
+        std::memcpy(compSpan.idx, comps.geometry.idx.data(), comps.geometry.idx.size()*sizeof(uint16_t));
+        arena.unmapDynamic();
+    }
+
+    // ---- Render list: static dial layer, then the hands layer ----
+    RenderList rl;
+    auto rgb = [&](ThemeColor c, float sx=1.0f, float sy=1.0f){
+        return makeRecord(T.color[c][0], T.color[c][1], T.color[c][2], sx, sy);
+    };
+    int bezelRec = rl.add(Mesh{}, rgb(TC_BEZEL)); // DIAL_RECORDS of them
+    rl.add(Mesh{},        rgb(TC_FACE, T.shape.bezelInner, T.shape.bezelInner));
+    rl.add(Mesh{},        rgb(TC_RING));
+    rl.add(M.minuteTicks, rgb(TC_TICKS));
+    rl.add(M.hourTicks,   rgb(TC_TICKS));
+    int dialLayer = rl.cut();
+    int numRec = addNumerals(rl, atlas, M.quad, labels, T.shape.numeralRadius, T.shape.numeralScale);
+    int numEnd = (int)rl.records.size();
+    int numeralLayer = rl.cut();
+
+    auto compMesh = [&](const ComplicationInstance& in){
+        return in.glyph >= 0 ? M.quad : GeometryArena::dynamic(compRegion, in.mesh);
+    };
+    int compFaceRec = (int)rl.records.size();
+    for(const ComplicationInstance& in : comps.face) rl.add(compMesh(in), complicationRecord(in, 0.0f, 0.0f, T));
+    int compFaceLayer = rl.cut();
+    int compRec = (int)rl.records.size();
+    for(size_t i=0; i<comps.items.size(); i++){
+        const ComplicationInstance* in = comps.liveOf(0, (int)i);
+        for(int j=0; j<comps.liveSize((int)i); j++)
+            rl.add(compMesh(in[j]), complicationRecord(in[j], comps.items[i]->cx, comps.items[i]->cy, T));
+    }
+    int compLayer = rl.cut();
+    rl.addReplicas(compRec, comps.liveCount, nClocks-1); // live records for dials 1..n-1
+    // Rewrites dial d's records of item i from its instances
+    auto writeComplication = [&](int d, int i, const Theme& t){
+        const Complication& c = *comps.items[i];
+        const ComplicationInstance* in = comps.liveOf(d, i);
+        for(int j=0; j<comps.liveSize(i); j++)
+            rl.records[compRec + d*comps.liveCount + comps.liveFirst[i] + j] = complicationRecord(in[j], c.cx, c.cy, t);
+    };
+
+    int hourRec = rl.add(M.hourHand, rgb(TC_HOUR));
+    rl.add(M.minuteHand,             rgb(TC_MINUTE));
+    rl.add(M.secondHand,             rgb(TC_SECOND));
+    int handLayer = rl.cut();
+    rl.addReplicas(hourRec, 3, nClocks-1); // hour/minute/second for dials 1..n-1
+    StatsOverlay statsOverlay;
+    if(overlay) statsOverlay.build(rl);
+
+    rl.buildChunks();
+    {
+        std::vector<float> xf;
+        for(int k=0; k<nClocks; k++){
+            xf.insert(xf.end(), { 1.0f/cols, 1.0f/rows,
+                                  -1.0f + (2*(k%cols) + 1)/(float)cols,
+                                   1.0f - (2*(k/cols) + 1)/(float)rows });
+        }
+        rl.setClocks(xf.data(), nClocks);
+    }
+
+    // ---- Theme: applied in place, nothing in the backend is recreated ----
+    // Colors and the numeral layout are record (UBO) updates; a tick or hand
+    // group is regenerated into its arena region only when its shape changed.
+    // The circles follow through DialLod on the next frame.
+    bool dialDirty = false; // cached dial must be redrawn
+    auto applyTheme = [&](const Theme& t){
+        auto color = [&](int id, ThemeColor c){
+            DrawRecord& d = rl.records[id];
+            d.r = t.color[c][0]; d.g = t.color[c][1]; d.b = t.color[c][2];
+        };
+        color(bezelRec+0, TC_BEZEL);
+        color(bezelRec+1, TC_FACE);
+        color(bezelRec+2, TC_RING);
+        color(bezelRec+3, TC_TICKS);
+        color(bezelRec+4, TC_TICKS);
+        for(int id=numRec; id<numEnd; id++) color(id, TC_NUMERALS);
+        for(size_t j=0; j<comps.face.size(); j++) rl.records[compFaceRec + j] = complicationRecord(comps.face[j], 0.0f, 0.0f, t);
+        for(int k=0; k<nClocks; k++)
+            for(size_t i=0; i<comps.items.size(); i++) writeComplication(k, (int)i, t);
+        for(int k=0; k<nClocks; k++){
+            color(hourRec + 3*k + 0, TC_HOUR);
+            color(hourRec + 3*k + 1, TC_MINUTE);
+            color(hourRec + 3*k + 2, TC_SECOND);
+        }
+
+        const ClockShape &a = applied.shape, &b = t.shape;
+        setTransform(rl.records[bezelRec+1], 0.0f, b.bezelInner, b.bezelInner); // face disc
+        layoutNumerals(rl, numRec, atlas, labels, b.numeralRadius, b.numeralScale);
+        auto differ = [](const auto& x, const auto& y){ return std::memcmp(&x, &y, sizeof(x)) != 0; };
+        if(differ(a.minuteTicks, b.minuteTicks) || differ(a.hourTicks, b.hourTicks)){
+            Mesh mt, ht;
+            if(arena.rebuild(tickRegion, [&](auto& g){ genTickMeshes(g, b, mt, ht); })){
+                rl.setMesh(bezelRec+3, GeometryArena::dynamic(tickRegion, mt));
+                rl.setMesh(bezelRec+4, GeometryArena::dynamic(tickRegion, ht));
+            }
+        }
+        if(differ(a.hour, b.hour) || differ(a.minute, b.minute) || differ(a.second, b.second) ||
+           a.hubRadius != b.hubRadius){
+            Mesh hh, mh, sh;
+            if(arena.rebuild(handRegion, [&](auto& g){ genHandMeshes(g, b, hh, mh, sh); })){
+                rl.setMesh(hourRec+0, GeometryArena::dynamic(handRegion, hh));
+                rl.setMesh(hourRec+1, GeometryArena::dynamic(handRegion, mh));
+                rl.setMesh(hourRec+2, GeometryArena::dynamic(handRegion, sh));
+            }
+        }
+        rl.syncChunks();
+        rl.update();
+        backend->setTheme(t);
+        applied = t;
+        dialDirty = g_damaged = true;
+    };
+    FrameProducer producer;
+    producer.zones = zones;
+    producer.sweep = sweep;
+    producer.time.useShared = !timeLocal;
+    producer.themeWatch.path = themePath;
+    if(producer.pollTheme()) applyTheme(producer.theme); // first frame is already themed
+    unsigned themeSeq = producer.themeSeq;
+
+    std::vector<float> angles(3*nClocks), lastAngles; // hour, minute, second per dial
+    int lastW = 0, lastH = 0;
+
+    FrameStats fs;
+    if(measure) fs.init(stats, statsCsv);
+    if(bench) fs.keep(benchFrames);
+    const int64_t benchStartNs = producer.time.utcNs();
+    // Export start: the given wall time today on the first dial (today for the date window)
+    const int64_t startOffset = zones.empty() ? producer.time.offset : 0;
+    const int64_t startDay = exportStartDay >= 0 ? exportStartDay*86400
+        : (benchStartNs/INT64_C(1000000000) + startOffset)/86400*86400;
+    const int64_t exportStartNs = exportStartSec < 0 ? benchStartNs
+        : (startDay + exportStartSec - startOffset)*INT64_C(1000000000);
+    FramePacer pacer;
+    const bool paced = sweep && !offline;
+    // Bench and export step synthetic time per frame, so they sample inline instead
+    FramePacket benchPacket;
+    producer.wakeRender = !continuous && !paced;
+    if(!offline) producer.start();
+    int exportFrame = 0;
+    const auto exportT0 = std::chrono::steady_clock::now();
+
+    PowerState power = PW_FULL;
+    bool small = false; // dial cells under SMALL_DIAL_PX: no MSAA, mesh path
+#ifdef CLOCK2D_BENCH
+    long allocsStartup = 0, allocsFirst = 0, allocsEnd = 0; // g_allocs at the first, second and past the last frame
+#endif
+    while(!win || !glfwWindowShouldClose(win)){
+        if(bench && fs.frame >= benchFrames) break;
+#ifdef CLOCK2D_BENCH
+        if(fs.frame == 0) allocsStartup = g_allocs.load();
+        if(fs.frame == 1) allocsFirst = g_allocs.load();
+#endif
+        if(exporting && exportFrame >= exportFrames) break;
+        // Power: offline runs always go flat out
+        if(!offline){
+            PowerState pw = choosePower(T.shape.second.length > 0.0f, sweep || continuous);
+            if(pw != power){
+                power = pw;
+                producer.setPower(pw);
+                if(stats) std::fprintf(stderr, "[Power] %s\n", POWER_NAMES[pw]);
+            }
+        }
+        const bool full = power == PW_FULL;
+        int64_t leadNs = 0; // display time minus sample time
+        if(paced && full)                        leadNs = pacer.wait(win);
+        else if((continuous && full) || offline){ if(win) glfwPollEvents(); }
+        else                                     glfwWaitEvents(); // the producer posts one per new packet
+        if(measure) fs.wait();
+
+        // Newest packet from the producer (or this frame's synthetic time)
+        const auto now = std::chrono::steady_clock::now();
+        const FramePacket* packet = &benchPacket;
+        if(bench) producer.sample(benchPacket, benchStartNs + fs.frame*INT64_C(1000000000), now);
+        else if(exporting)
+            producer.sample(benchPacket, exportStartNs + (int64_t)std::llround(exportFrame*1e9/exportFps), now);
+        else {
+            producer.slot.take();
+            packet = &producer.slot.latest();
+            if(packet->sampled == std::chrono::steady_clock::time_point{}) continue; // none yet
+        }
+        if(packet->themeSeq != themeSeq){ applyTheme(packet->theme); themeSeq = packet->themeSeq; }
+        packet->anglesAt(now + std::chrono::nanoseconds(leadNs), sweep && full, angles.data(), nClocks);
+
+        // Complications: only the ones whose deadline passed are re-evaluated
+        bool compChanged = false;
+        if(!comps.items.empty()){
+            const int64_t utcNow = packet->utcNs + leadNs +
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - packet->sampled).count();
+            for(int key : g_keys) comps.key(key, utcNow);
+            g_keys.clear();
+            for(int k=0; k<nClocks; k++){
+                if(!comps.update(k, ComplicationTime{ utcNow, packet->offsets[k] })) continue;
+                compChanged = true;
+                for(size_t i=0; i<comps.items.size(); i++)
+                    if(comps.changed[k*comps.items.size() + i]) writeComplication(k, (int)i, T);
+            }
+            if(compChanged) rl.update();
+            if(!offline) producer.setDeadline(g_iconified ? INT64_MAX : comps.nextDeadline());
+        }
 
-        // ---- Dial ----
-        glUniform1f(uAng, 0.0f);
-        glUniform2f(uTr,  0.0f, 0.0f);
+        // Nothing visible changed (woke early, or on an unrelated event)
+        if(!((continuous || sweep) && full) && !offline && !g_damaged && !compChanged && angles==lastAngles) continue;
 
-        // Bezel (subtle brown)
-        glUniform3f(uCol, 0.42f, 0.22f, 0.12f);
-        glUniform2f(uSc,  1.0f, 1.0f); bezel.draw();
+        int W=winW, H=winH;
+        if(!exporting && win) glfwGetFramebufferSize(win,&W,&H);
+        if(W <= 0 || H <= 0) continue; // iconified on some platforms
+        const bool smallNow = !offline && std::min(W/cols, H/rows) < SMALL_DIAL_PX;
+        if(smallNow != small){
+            small = smallNow;
+            backend->setSmall(small);
+            g_damaged = true; // the path or the dial samples change
+            if(stats) std::fprintf(stderr, "[Power] %s dials\n", small ? "small" : "normal");
+        }
+        if(measure){
+            fs.beginFrame(*backend); fs.mark(PH_TIME);
+            fs.power = power; fs.small = small;
+        }
 
-        // White dial (restore face)
-        glUniform3f(uCol, 1.0f, 1.0f, 1.0f);
-        glUniform2f(uSc,  0.86f, 0.86f); face.draw();
+        // Damage: the old and new boxes of every hand that moved and every
+        // complication that changed, or all of it
+        DamageRect damage = DamageRect::whole(W, H);
+        if(!g_damaged && !dialDirty && W == lastW && H == lastH && lastAngles.size() == angles.size()){
+            const HandSpec* spec[3] = { &T.shape.hour, &T.shape.minute, &T.shape.second };
+            damage = DamageRect{};
+            for(int i=0; i<3*nClocks; i++){
+                if(angles[i] == lastAngles[i]) continue;
+                const float hub = i%3 == 2 ? T.shape.hubRadius : 0.0f;
+                const float* g = &rl.clockXf[4*(i/3)];
+                damage.unite(handDamage(*spec[i%3], hub, lastAngles[i], g, W, H));
+                damage.unite(handDamage(*spec[i%3], hub, angles[i], g, W, H));
+            }
+            for(size_t i=0; compChanged && i<comps.changed.size(); i++){
+                if(!comps.changed[i]) continue;
+                const Complication& c = *comps.items[i % comps.items.size()];
+                damage.unite(circleDamage(c.cx, c.cy, c.radius, &rl.clockXf[4*(i / comps.items.size())], W, H));
+            }
+        }
+        g_damaged = false;
+        lastAngles = angles;
+        lastW = W; lastH = H;
 
-        // Chapter ring
-        glUniform3f(uCol, 0.75f, 0.75f, 0.75f);
-        glUniform2f(uSc,  1.0f, 1.0f); innerRing.draw();
+        backend->beginFrame(W, H, damage, T.color[TC_BACKGROUND]);
+        if(overlay) statsOverlay.layout(rl, W, H); // before any draw publishes the records
 
-        // Ticks
-        glUniform3f(uCol, 0.0f, 0.0f, 0.0f);
-        glUniform2f(uSc,  1.0f, 1.0f);
-        minuteTicks.draw();
-        hourTicks.draw();
+        if(backend->analyticDial()){
+            if(measure) fs.mark(PH_SETUP);
+            backend->beginPass(GP_DIAL);
+            backend->drawAnalyticDial(angles.data(), nClocks, cols, rows);
+        } else {
+            // ---- Setup: LOD meshes and hand records ----
+            if(lod.update(W/cols, H/rows, arena, T.shape)){
+                rl.setMesh(bezelRec+0, lod.bezel);
+                rl.setMesh(bezelRec+1, lod.face);
+                rl.setMesh(bezelRec+2, lod.innerRing);
+                rl.syncChunks();
+                dialDirty = true;
+            }
+            for(int i=0; i<3*nClocks; i++) setTransform(rl.records[hourRec+i], angles[i]);
+            rl.update();
+            if(measure) fs.mark(PH_SETUP);
 
-        // ---- Numerals (upright) ----
-        float rNum = 0.73f;  // tuck near inner ring
-        float sNum = 0.10f;  // compact
-        glUniform3f(uCol, 0.0f, 0.0f, 0.0f);
-        for(int n=1;n<=12;n++){
-            float ang = numeralAngle(n);
-            float cx = std::cos(ang)*rNum;
-            float cy = std::sin(ang)*rNum;
-            glUniform1f(uAng, 0.0f);        // keep upright
-            glUniform2f(uSc,  sNum, sNum);
-            glUniform2f(uTr,  cx, cy);
-            numerals[n].mesh.draw();
+            // ---- Dial (redrawn only when its geometry/colors change), then
+            // complications and hands: one draw each for every dial ----
+            const int staticLayers[3] = { dialLayer, numeralLayer, compFaceLayer };
+            backend->drawStatic(rl, staticLayers, 3, nClocks, dialDirty);
+            dialDirty = false;
+            backend->beginPass(GP_HANDS);
+            backend->drawLayer(rl, compLayer, nClocks, comps.liveCount, 0);
+            backend->drawLayer(rl, handLayer, nClocks, 3, 0);
         }
+        backend->endPass();
 
-        // ---- Hands ----
-        glUniform2f(uTr, 0.0f, 0.0f);
+        if(overlay) backend->drawLayer(rl, statsOverlay.layer, 1, 0, SCREEN_CLOCK);
+        backend->endFrame();
+        if(measure) fs.mark(PH_SUBMIT);
 
-        // Hour (black)
-        glUniform3f(uCol, 0,0,0);
-        glUniform1f(uAng, aH);
-        glUniform2f(uSc,  1.0f, 1.0f);
-        hourHand.draw();
+        if(exporting) backend->readback(exporter, exportFrame++);
+        else {
+            if(paced) pacer.submitted();
+            backend->present(win, damage, W, H);
+            if(paced) pacer.swapped();
+        }
 
-        // Minute (black)
-        glUniform1f(uAng, aM);
-        minuteHand.draw();
+        if(measure){
+            fs.mark(PH_SWAP);
+            if(fs.endFrame() && overlay){
+                double gpu = fs.avgGpu[GP_DIAL] + fs.avgGpu[GP_NUMERALS] + fs.avgGpu[GP_HANDS];
+                const long values[StatsOverlay::ROWS] = {
+                    std::lround(1000.0*(fs.avgCpu[PH_TIME] + fs.avgCpu[PH_SETUP] + fs.avgCpu[PH_SUBMIT])),
+                    std::lround(1000.0*gpu), std::lround(fs.avgDraws), std::lround(fs.avgVerts) };
+                statsOverlay.set(rl, M.glyphs, values);
+                g_damaged = true; // show the new numbers without waiting for the next tick
+            }
+        }
+    }
 
-        // Second (gold)
-        glUniform3f(uCol, 0.80f, 0.70f, 0.35f);
-        glUniform1f(uAng, aS);
-        secondHand.draw();
+#ifdef CLOCK2D_BENCH
+    allocsEnd = g_allocs.load();
+#endif
+    if(bench){
+        int W=winW, H=winH;
+        if(win) glfwGetFramebufferSize(win,&W,&H);
+        fs.report(W, H, nClocks);
+    }
+    backend->report(exporting ? exportFrame : fs.frame);
 
-        glfwSwapBuffers(win);
+    int status = 0;
+    if(bench){
+        double measured[BK_COUNT] = { (double)fs.counters.draws, (double)fs.counters.verts,
+                                      fs.framePercentile(0.50), fs.framePercentile(0.99), 0.0, 0.0 };
+#ifdef CLOCK2D_BENCH
+        if(fs.frame > 1){
+            measured[BK_ALLOCS] = (double)allocsStartup;
+            measured[BK_FRAME_ALLOCS] = (double)(allocsEnd - allocsFirst)/(fs.frame - 1);
+            std::printf("[Bench] allocations: %ld before the first frame, %.2f per frame after it\n",
+                        allocsStartup, measured[BK_FRAME_ALLOCS]);
+        }
+#endif
+        if(!budget.check(measured)) status = 1;
+    }
+    if(exporting){
+        backend->flushReadback(exporter);
+        bool ok = exporter.finish();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - exportT0).count();
+        std::fprintf(stderr, "[Export] %d frames %dx%d in %.2f s (%.1f fps)%s\n",
+                     exportFrame, winW, winH, sec, exportFrame/sec, ok ? "" : ", with write errors");
+        if(golden){
+            std::fprintf(stderr, "[Golden] %d of %d frames match %s\n",
+                         exportFrame - exporter.goldenFailed, exportFrame, golden);
+        }
+        if(!ok || exporter.goldenFailed) status = 1;
     }
 
     // cleanup
-    for(int n=1;n<=12;n++) numerals[n].mesh.destroy();
-    secondHand.destroy(); minuteHand.destroy(); hourHand.destroy();
-    hourTicks.destroy(); minuteTicks.destroy();
-    innerRing.destroy(); face.destroy(); bezel.destroy();
-    glDeleteProgram(prog);
-    glfwDestroyWindow(win);
-    glfwTerminate();
-    return 0;
+    producer.stop();
+    timeServer.stop();
+    discipline.stop();
+    fs.destroy();
+    backend->destroy();
+    if(win){
+        glfwDestroyWindow(win);
+        glfwTerminate();
+    }
+    return status;
 }
@@ -0,0 +1,100 @@
+// src/present.cpp
+#include "present.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef CLOCK2D_EGL_DAMAGE
+#define GLFW_EXPOSE_NATIVE_EGL
+#include <GLFW/glfw3native.h>
+#include <EGL/eglext.h>
+
+// Fetched through glfwGetProcAddress (eglGetProcAddress on EGL contexts),
+// so the app never links libEGL itself.
+typedef const char* (EGLAPIENTRY *QueryStringFn)(EGLDisplay, EGLint);
+typedef EGLBoolean (EGLAPIENTRY *QuerySurfaceFn)(EGLDisplay, EGLSurface, EGLint, EGLint*);
+typedef EGLBoolean (EGLAPIENTRY *SwapWithDamageFn)(EGLDisplay, EGLSurface, const EGLint*, EGLint);
+
+static bool hasExtension(const char* list, const char* name){
+    const size_t n = std::strlen(name);
+    for(const char* p = list; p && (p = std::strstr(p, name)); p += n)
+        if((p == list || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    return false;
+}
+#endif
+
+void DamageRect::unite(const DamageRect& r){
+    if(r.empty()) return;
+    if(empty()){ *this = r; return; }
+    x0 = std::min(x0, r.x0); y0 = std::min(y0, r.y0);
+    x1 = std::max(x1, r.x1); y1 = std::max(y1, r.y1);
+}
+
+DamageRect DamageRect::clipped(int W, int H) const {
+    DamageRect r{ std::max(x0, 0), std::max(y0, 0), std::min(x1, W), std::min(y1, H) };
+    return r.empty() ? DamageRect{} : r;
+}
+
+bool PartialPresent::init(GLFWwindow* win){
+#ifdef CLOCK2D_EGL_DAMAGE
+    EGLDisplay dpy = glfwGetEGLDisplay();
+    EGLSurface surf = glfwGetEGLSurface(win); // EGL_NO_SURFACE unless the context is EGL
+    if(dpy == EGL_NO_DISPLAY || surf == EGL_NO_SURFACE) return false;
+    QueryStringFn queryString = (QueryStringFn)glfwGetProcAddress("eglQueryString");
+    querySurface = glfwGetProcAddress("eglQuerySurface");
+    if(!queryString || !querySurface) return false;
+    const char* ext = queryString(dpy, EGL_EXTENSIONS);
+    if(hasExtension(ext, "EGL_KHR_swap_buffers_with_damage"))
+        swapWithDamage = glfwGetProcAddress("eglSwapBuffersWithDamageKHR");
+    else if(hasExtension(ext, "EGL_EXT_swap_buffers_with_damage"))
+        swapWithDamage = glfwGetProcAddress("eglSwapBuffersWithDamageEXT");
+    GLint samples = 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGetIntegerv(GL_SAMPLES, &samples);
+    display = dpy; surface = surf;
+    hinted  = swapWithDamage != nullptr;
+    scissor = hasExtension(ext, "EGL_EXT_buffer_age") && samples == 0;
+    return hinted || scissor;
+#else
+    (void)win;
+    return false;
+#endif
+}
+
+#ifdef CLOCK2D_EGL_DAMAGE
+int PartialPresent::bufferAge() const {
+    EGLint age = 0;
+    if(!((QuerySurfaceFn)querySurface)((EGLDisplay)display, (EGLSurface)surface, EGL_BUFFER_AGE_EXT, &age)) return 0;
+    return age;
+}
+#endif
+
+DamageRect PartialPresent::repaint(const DamageRect& damage, int W, int H){
+    const DamageRect all = DamageRect::whole(W, H);
+    if(!scissor) return all;
+#ifdef CLOCK2D_EGL_DAMAGE
+    // age n: the buffer last showed the frame n presents ago (0 = undefined)
+    const int age = bufferAge();
+    if(age <= 0 || age > HISTORY || age - 1 > frames) return all;
+    DamageRect r = damage;
+    for(int i=0; i<age-1; i++) r.unite(history[i]);
+    return r.clipped(W, H);
+#else
+    (void)damage;
+    return all;
+#endif
+}
+
+void PartialPresent::present(GLFWwindow* win, const DamageRect& damage, int W, int H){
+    const DamageRect d = damage.clipped(W, H);
+    for(int i=HISTORY-1; i>0; i--) history[i] = history[i-1];
+    history[0] = d;
+    frames++;
+#ifdef CLOCK2D_EGL_DAMAGE
+    if(hinted && !d.empty()){
+        const EGLint rect[4] = { d.x0, d.y0, d.x1 - d.x0, d.y1 - d.y0 };
+        if(((SwapWithDamageFn)swapWithDamage)((EGLDisplay)display, (EGLSurface)surface, rect, 1)) return;
+    }
+#endif
+    glfwSwapBuffers(win); // empty damage too: a zero-rectangle swap means "all changed" anyway
+}
@@ -0,0 +1,38 @@
+// src/present.h
+// Partial presentation: repaint only the damaged part of the window and
+// tell the compositor which part changed.
+// With an EGL window surface (Linux builds with CLOCK2D_EGL_DAMAGE) the
+// buffer age (EGL_EXT_buffer_age) says how many frames old the back buffer
+// is, so the renderer can scissor to this frame's damage plus whatever
+// changed since that buffer was shown; the swap passes the damage along
+// (EGL_KHR/EXT_swap_buffers_with_damage). Everywhere else, and when the
+// window is multisampled (its sample buffer does not survive the swap),
+// every frame repaints and presents the whole window.
+#pragma once
+
+#include "gl_platform.h"
+#include "render_backend.h" // DamageRect
+
+struct PartialPresent {
+    static const int HISTORY = 4;   // frames of damage kept for buffer ages up to this
+
+    // False if the window can only present whole frames.
+    bool init(GLFWwindow* win);
+    // Back buffer region to repaint so it shows this frame, given what
+    // changed since the last presented frame.
+    DamageRect repaint(const DamageRect& damage, int W, int H);
+    // Swaps; damage is what changed since the last presented frame.
+    void present(GLFWwindow* win, const DamageRect& damage, int W, int H);
+
+    bool scissor=false;             // repaint() can return less than the window
+    bool hinted=false;              // swaps carry damage rectangles
+    DamageRect history[HISTORY];    // [0] = last presented frame's damage
+    int  frames=0;                  // presented so far (caps the usable age)
+#ifdef CLOCK2D_EGL_DAMAGE
+    void* display=nullptr;              // EGLDisplay / EGLSurface
+    void* surface=nullptr;
+    GLFWglproc querySurface=nullptr;    // eglQuerySurface
+    GLFWglproc swapWithDamage=nullptr;  // eglSwapBuffersWithDamage{KHR,EXT}
+    int   bufferAge() const;
+#endif
+};
@@ -0,0 +1,213 @@
+// src/render_backend.h
+// The seam between the frame loop and whatever turns records into pixels.
+// The loop owns the CPU side: DrawRecords, their meshes and layers in a
+// RenderList, and GeometryArena's bookkeeping. A RenderBackend stores the
+// arena's vertices, draws layers, and presents or reads back the frame:
+// GlBackend (main.cpp) with instanced draws and a cached dial, SoftBackend
+// (soft_raster.h) with the tile rasterizer. GL-free; main() picks one.
+#pragma once
+
+#include "clock_geom.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+struct GLFWwindow;
+struct Theme;
+
+// ================= Damage =================
+// Window pixels, origin bottom-left like glScissor.
+struct DamageRect {
+    int x0=0, y0=0, x1=0, y1=0;
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    void unite(const DamageRect& r);
+    DamageRect clipped(int W, int H) const;
+    static DamageRect whole(int W, int H){ return { 0, 0, W, H }; }
+};
+
+// ================= Draw records =================
+// Each element (bezel, face, ticks, every numeral digit, each hand) is a
+// DrawRecord: mesh range + angle/scale/translate/color.
+struct DrawRecord {            // std140 layout of `Record` in VS_SRC
+    float m[4];                // column-major mat2 = scale * rotation
+    float tx, ty, glyph, _p1;  // glyph: atlas cell + 1, 0 for a solid mesh
+    float r, g, b, a;
+};
+// Angle is radians, clockwise positive. The vertex stage only does a mat2
+// multiply-add; cos/sin run here once per record, and not at all for the
+// unrotated static layers.
+inline void setTransform(DrawRecord& d, float angle,
+                         float sx=1.0f, float sy=1.0f, float tx=0.0f, float ty=0.0f){
+    float c = 1.0f, s = 0.0f;
+    if(angle != 0.0f){ c = std::cos(angle); s = std::sin(angle); }
+    d.m[0] = c*sx; d.m[1] = s*sy;
+    d.m[2] =-s*sx; d.m[3] = c*sy;
+    d.tx = tx; d.ty = ty;
+}
+inline DrawRecord makeRecord(float r, float g, float b,
+                             float sx=1.0f, float sy=1.0f, float tx=0.0f, float ty=0.0f){
+    DrawRecord d{ {1,0,0,1},  0,0,0,0,  r, g, b, 1.0f };
+    setTransform(d, 0.0f, sx, sy, tx, ty);
+    return d;
+}
+
+static const int MAX_RECORDS = 256; // 48 B each: fits the 16 KB UBO minimum
+static const int MAX_CLOCKS  = 64;  // dials per render list (dashboard grid)
+static const int SCREEN_CLOCK = MAX_CLOCKS; // identity placement slot (overlays)
+static const int DIAL_RECORDS = 5;  // bezel, face, ring, minute and hour ticks
+static const int CHUNK_VERTS = 48;  // indices per chunk: multiple of 3, bounds padding
+
+// Submission counters for the stats overlay; reset by FrameStats each frame.
+struct DrawCounters { long draws=0, verts=0; };
+extern DrawCounters g_draws;
+
+// GPU time is measured per pass (FrameStats)
+enum StatPass { GP_DIAL, GP_NUMERALS, GP_HANDS, GP_COUNT };
+
+// ================= Render list (one batched draw per layer) =================
+// Records are edited here on the CPU and published by the backend when
+// their version moved. Each mesh is split into CHUNK_VERTS slices and a
+// layer (a contiguous run of chunks) is drawn in a single call.
+struct RenderList {
+    // A layer is a run of records, drawn in one call; its chunk range is
+    // derived from the records' meshes by buildChunks().
+    struct Layer { int firstRecord=0, recordCount=0; int firstChunk=0, chunkCount=0; };
+
+    std::vector<DrawRecord> records;
+    std::vector<Mesh>       meshes;   // one per record
+    std::vector<Layer>      layers;
+    std::vector<int32_t>    chunks;   // 4 ints per chunk: first index, count, record, base vertex
+    float clockXf[4*(MAX_CLOCKS+1)] = {}; // per-dial placement (the Clocks UBO)
+    bool  chunksDirty=false;
+    // Bumped on every edit; a backend republishes what moved since its last draw
+    unsigned recordsVersion=1, chunksVersion=1, clocksVersion=1;
+
+    RenderList(){
+        const float identity[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+        for(int i=0; i<4; i++) clockXf[i] = clockXf[4*SCREEN_CLOCK + i] = identity[i];
+    }
+    // Records still free; callers size their layers against this up front
+    int room() const { return MAX_RECORDS - (int)records.size(); }
+    // The new record's id, or -1 (nothing added) when the list is full.
+    int add(const Mesh& m, const DrawRecord& rec){
+        int id = (int)records.size();
+        if(id >= MAX_RECORDS){ std::fprintf(stderr, "[RenderList] record limit (%d) reached\n", MAX_RECORDS); return -1; }
+        records.push_back(rec);
+        meshes.push_back(m);
+        return id;
+    }
+    // Per-dial copies of records [first, first+count), appended contiguously
+    // after the originals' layer: dial k uses record id + k*count when the
+    // layer is drawn with recordStride = count. They carry no mesh, so the
+    // layer that eventually absorbs them draws nothing extra. All or none:
+    // -1 if they do not fit.
+    int addReplicas(int first, int count, int copies){
+        int start = (int)records.size();
+        if(count*copies > room()){ std::fprintf(stderr, "[RenderList] record limit (%d) reached\n", MAX_RECORDS); return -1; }
+        for(int c=0; c<copies; c++)
+            for(int i=0; i<count; i++) add(Mesh{}, records[first+i]);
+        return start;
+    }
+    // Closes the current layer: every record added since the previous cut.
+    int cut(){
+        Layer l;
+        if(!layers.empty()) l.firstRecord = layers.back().firstRecord + layers.back().recordCount;
+        l.recordCount = (int)records.size() - l.firstRecord;
+        layers.push_back(l);
+        return (int)layers.size() - 1;
+    }
+    // Swap the geometry behind a record (e.g. a new LOD); chunks are rebuilt
+    // by the next syncChunks().
+    void setMesh(int id, const Mesh& m){
+        meshes[id] = m;
+        chunksDirty = true;
+    }
+    void buildChunks(){
+        chunks.clear();
+        for(Layer& l : layers){
+            l.firstChunk = (int)(chunks.size()/4);
+            for(int id=l.firstRecord; id<l.firstRecord+l.recordCount; id++){
+                const Mesh& m = meshes[id];
+                for(int32_t i=0; i<m.count; i+=CHUNK_VERTS){
+                    int32_t n = m.count - i < CHUNK_VERTS ? m.count - i : CHUNK_VERTS;
+                    chunks.insert(chunks.end(), { m.firstIndex + i, n, id, m.baseVertex });
+                }
+            }
+            l.chunkCount = (int)(chunks.size()/4) - l.firstChunk;
+        }
+        chunksVersion++;
+    }
+    void syncChunks(){
+        if(!chunksDirty) return;
+        buildChunks();
+        chunksDirty = false;
+    }
+    // Marks the records as edited. Published by the next draw as a whole,
+    // so one copy per frame however many records changed (make all edits
+    // before drawing).
+    void update(){ recordsVersion++; }
+    // Per-dial placement, 4 floats each: NDC scale xy, NDC translate xy.
+    void setClocks(const float* xf, int n){
+        for(int i=0; i<4*n; i++) clockXf[i] = xf[i];
+        clocksVersion++;
+    }
+};
+
+// ================= Backend =================
+// Where read-back frames go (FrameExporter): rgba is W x H RGBA8, bottom
+// row first, or null when the frame could not be read (it still counts).
+struct FrameSink {
+    virtual ~FrameSink() = default;
+    virtual void submit(int frame, const unsigned char* rgba) = 0;
+};
+
+struct RenderBackend {
+    virtual ~RenderBackend() = default;
+
+    // ---- Geometry storage behind GeometryArena ----
+    // nv/ni static vertices (xy pairs) and indices, in room for totalV/totalI.
+    virtual void uploadGeometry(const float* v, int nv, const uint16_t* idx, int ni, int totalV, int totalI) = 0;
+    // nv vertices from `vertex` and ni indices from `index`, writable until
+    // unmapGeometry(). False (nothing mapped) on failure.
+    virtual bool mapGeometry(int vertex, int nv, int index, int ni, float*& v, uint16_t*& idx) = 0;
+    // False if the contents were lost while mapped.
+    virtual bool unmapGeometry() = 0;
+
+    // ---- State beyond the render list ----
+    virtual void setTheme(const Theme&){}
+    virtual void setSmall(bool){}        // dial cells under SMALL_DIAL_PX: cheaper sampling
+    // True if dials and hands are drawn analytically this frame, in one
+    // drawAnalyticDial() instead of the layers (angles: 3 per dial).
+    virtual bool analyticDial() const { return false; }
+    virtual void drawAnalyticDial(const float* /*angles*/, int /*clocks*/, int /*cols*/, int /*rows*/){}
+
+    // ---- Frame ----
+    // Starts a W x H frame; only what `damage` covers (changed since the
+    // last presented frame) needs repainting. bg: the clear color.
+    virtual void beginFrame(int W, int H, const DamageRect& damage, const float bg[3]) = 0;
+    // The layers that only change with the theme, LOD or size, in draw
+    // order; dirty if they did since the last frame (else they may be cached).
+    virtual void drawStatic(const RenderList& rl, const int* layers, int count, int clocks, bool dirty) = 0;
+    // A layer that moves between frames, for `clocks` dials from clockBase
+    // (see RenderList::addReplicas for recordStride).
+    virtual void drawLayer(const RenderList& rl, int layer, int clocks, int recordStride, int clockBase) = 0;
+    virtual void endFrame() = 0;
+    // Shows the frame in the window, damage as for beginFrame()
+    virtual void present(GLFWwindow* win, const DamageRect& damage, int W, int H) = 0;
+    // Instead of present(): the frame goes to `sink`, now or a few frames
+    // later; flushReadback() hands over the ones still in flight.
+    virtual void readback(FrameSink& sink, int frame) = 0;
+    virtual void flushReadback(FrameSink&){}
+
+    // ---- Timing ----
+    virtual void beginPass(StatPass){}   // passes do not nest: begins close the open one
+    virtual void endPass(){}
+    // Per pass, from a frame that has completed; 0 when not measured.
+    virtual void gpuTimes(double ms[GP_COUNT]){ for(int p=0; p<GP_COUNT; p++) ms[p] = 0.0; }
+    // End-of-run summary on stderr, for `frames` frames
+    virtual void report(long /*frames*/) const {}
+
+    virtual void destroy() = 0;
+};
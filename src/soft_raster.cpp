@@ -0,0 +1,393 @@
+// src/soft_raster.cpp
+#include "soft_raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// ================= 4-wide SIMD =================
+// Just what the inner loop needs: float lanes for the edge functions, a
+// lane mask for coverage, and a masked store of one color into 4 samples.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+typedef __m128  F4;
+typedef __m128i M4;
+static inline F4 splat(float v){ return _mm_set1_ps(v); }
+static inline F4 ramp(){ return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline F4 madd(F4 a, F4 b, F4 c){ return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline M4 inside(F4 e0, F4 e1, F4 e2){
+    const F4 z = _mm_setzero_ps();
+    return _mm_castps_si128(_mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, z), _mm_cmpge_ps(e1, z)), _mm_cmpge_ps(e2, z)));
+}
+static inline bool none(M4 m){ return _mm_movemask_epi8(m) == 0; }
+static inline int  bits(M4 m){ return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+static inline void store(uint32_t* dst, M4 m, uint32_t color){
+    const M4 old = _mm_loadu_si128((const M4*)dst);
+    _mm_storeu_si128((M4*)dst, _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32((int)color)), _mm_andnot_si128(m, old)));
+}
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+typedef float32x4_t F4;
+typedef uint32x4_t  M4;
+static inline F4 splat(float v){ return vdupq_n_f32(v); }
+static inline F4 ramp(){ static const float r[4] = { 0.0f, 1.0f, 2.0f, 3.0f }; return vld1q_f32(r); }
+static inline F4 madd(F4 a, F4 b, F4 c){ return vmlaq_f32(c, a, b); }
+static inline M4 inside(F4 e0, F4 e1, F4 e2){
+    const F4 z = vdupq_n_f32(0.0f);
+    return vandq_u32(vandq_u32(vcgeq_f32(e0, z), vcgeq_f32(e1, z)), vcgeq_f32(e2, z));
+}
+static inline bool none(M4 m){
+    uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return (vget_lane_u32(t, 0) | vget_lane_u32(t, 1)) == 0;
+}
+static inline int bits(M4 m){
+    return (int)((vgetq_lane_u32(m, 0) & 1) | (vgetq_lane_u32(m, 1) & 2) |
+                 (vgetq_lane_u32(m, 2) & 4) | (vgetq_lane_u32(m, 3) & 8));
+}
+static inline void store(uint32_t* dst, M4 m, uint32_t color){
+    vst1q_u32(dst, vbslq_u32(m, vdupq_n_u32(color), vld1q_u32(dst)));
+}
+#else
+struct F4 { float v[4]; };
+struct M4 { uint32_t v[4]; };
+static inline F4 splat(float x){ return F4{{ x, x, x, x }}; }
+static inline F4 ramp(){ return F4{{ 0.0f, 1.0f, 2.0f, 3.0f }}; }
+static inline F4 madd(F4 a, F4 b, F4 c){
+    for(int i=0; i<4; i++) c.v[i] += a.v[i]*b.v[i];
+    return c;
+}
+static inline M4 inside(F4 e0, F4 e1, F4 e2){
+    M4 m;
+    for(int i=0; i<4; i++) m.v[i] = (e0.v[i] >= 0.0f && e1.v[i] >= 0.0f && e2.v[i] >= 0.0f) ? ~0u : 0u;
+    return m;
+}
+static inline bool none(M4 m){ return !(m.v[0] | m.v[1] | m.v[2] | m.v[3]); }
+static inline int  bits(M4 m){ return (m.v[0] & 1) | (m.v[1] & 2) | (m.v[2] & 4) | (m.v[3] & 8); }
+static inline void store(uint32_t* dst, M4 m, uint32_t color){
+    for(int i=0; i<4; i++) if(m.v[i]) dst[i] = color;
+}
+#endif
+
+// 4x rotated grid, offsets from the pixel center
+static const float SAMPLE_X[SoftRasterizer::SAMPLES] = { -0.125f,  0.375f, -0.375f, 0.125f };
+static const float SAMPLE_Y[SoftRasterizer::SAMPLES] = { -0.375f, -0.125f,  0.125f, 0.375f };
+
+uint32_t SoftRasterizer::pack(float r, float g, float b){
+    auto u8 = [](float v){ return (uint32_t)std::lround(std::min(std::max(v, 0.0f), 1.0f)*255.0f); };
+    return u8(r) | u8(g) << 8 | u8(b) << 16 | 0xFF000000u;
+}
+
+// ================= Frame =================
+void SoftRasterizer::init(int W, int H, unsigned threads){
+    w = W; h = H;
+    tilesX = (w + TILE - 1)/TILE;
+    tilesY = (h + TILE - 1)/TILE;
+    pixels.assign((size_t)w*h, 0);
+    const size_t nTiles = (size_t)tilesX*tilesY;
+    binStart.assign(nTiles + 1, 0);
+    binCursor.assign(nTiles, 0);
+    prevDynamic.assign(nTiles, 0);
+    dirty.assign(nTiles, 0);
+    callerSamples.resize(SAMPLES*TILE*TILE);
+    resized = true;
+    for(unsigned i=(unsigned)workers.size(); i<threads; i++){
+        const unsigned g = generation;
+        workers.emplace_back([this, g]{ worker(g); });
+    }
+}
+
+void SoftRasterizer::begin(uint32_t bg){
+    background = bg;
+    tris.clear();
+}
+
+// Edge functions and bounds; false if the triangle is degenerate or off screen.
+bool SoftRasterizer::setup(const float xy[6], Tri& t) const {
+    float x0 = xy[0], y0 = xy[1], x1 = xy[2], y1 = xy[3], x2 = xy[4], y2 = xy[5];
+    float area = (x1 - x0)*(y2 - y0) - (y1 - y0)*(x2 - x0);
+    if(area == 0.0f) return false;
+    if(area < 0.0f){ std::swap(x1, x2); std::swap(y1, y2); } // counter-clockwise from here on
+    const float vx[3] = { x0, x1, x2 }, vy[3] = { y0, y1, y2 };
+    for(int i=0; i<3; i++){
+        int j = (i + 1) % 3;
+        t.A[i] = -(vy[j] - vy[i]);
+        t.B[i] =   vx[j] - vx[i];
+        t.C[i] = -(t.A[i]*vx[i] + t.B[i]*vy[i]);
+    }
+    t.minX = std::min(x0, std::min(x1, x2)); t.maxX = std::max(x0, std::max(x1, x2));
+    t.minY = std::min(y0, std::min(y1, y2)); t.maxY = std::max(y0, std::max(y1, y2));
+    return !(t.maxX < 0.0f || t.maxY < 0.0f || t.minX >= (float)w || t.minY >= (float)h);
+}
+
+void SoftRasterizer::add(const float xy[6], uint32_t color, bool dynamic){
+    Tri t;
+    if(!setup(xy, t)) return;
+    t.color = color;
+    t.dynamic = dynamic;
+    t.sdf = nullptr;
+    tris.push_back(t);
+}
+
+void SoftRasterizer::addSdf(const float xy[6], const float uv[6], uint32_t color, bool dynamic,
+                            const uint8_t* sdf, int texW, int texH){
+    Tri t;
+    if(!setup(xy, t)) return;
+    t.color = color;
+    t.dynamic = dynamic;
+    t.sdf = sdf; t.texW = texW; t.texH = texH;
+    // Planes through the three vertices' texel coordinates (texel centers at integers)
+    const float dx1 = xy[2] - xy[0], dy1 = xy[3] - xy[1], dx2 = xy[4] - xy[0], dy2 = xy[5] - xy[1];
+    const float det = dx1*dy2 - dx2*dy1;
+    auto plane = [&](float* P, float f0, float f1, float f2){
+        const float d1 = f1 - f0, d2 = f2 - f0;
+        P[0] = (d1*dy2 - d2*dy1)/det;
+        P[1] = (d2*dx1 - d1*dx2)/det;
+        P[2] = f0 - P[0]*xy[0] - P[1]*xy[1];
+    };
+    plane(t.U, uv[0]*texW - 0.5f, uv[2]*texW - 0.5f, uv[4]*texW - 0.5f);
+    plane(t.V, uv[1]*texH - 0.5f, uv[3]*texH - 0.5f, uv[5]*texH - 0.5f);
+    tris.push_back(t);
+}
+
+// Bilinear distance-field lookup at pixel-space (x, y).
+static bool sdfInside(const SoftRasterizer::Tri& t, float x, float y){
+    float u = t.U[0]*x + t.U[1]*y + t.U[2];
+    float v = t.V[0]*x + t.V[1]*y + t.V[2];
+    u = std::min(std::max(u, 0.0f), (float)(t.texW - 1));
+    v = std::min(std::max(v, 0.0f), (float)(t.texH - 1));
+    const int iu = (int)u, iv = (int)v;
+    const int iu1 = std::min(iu + 1, t.texW - 1), iv1 = std::min(iv + 1, t.texH - 1);
+    const float fu = u - iu, fv = v - iv;
+    const uint8_t* r0 = t.sdf + (size_t)iv*t.texW;
+    const uint8_t* r1 = t.sdf + (size_t)iv1*t.texW;
+    const float a = r0[iu] + (r0[iu1] - r0[iu])*fu;
+    const float b = r1[iu] + (r1[iu1] - r1[iu])*fu;
+    return a + (b - a)*fv >= 127.5f;
+}
+
+int SoftRasterizer::end(bool full){
+    const int nTiles = tilesX*tilesY;
+    auto tileRange = [&](const Tri& t, int& tx0, int& ty0, int& tx1, int& ty1){
+        tx0 = std::max(0, (int)std::floor(t.minX - 1.0f)/TILE);
+        ty0 = std::max(0, (int)std::floor(t.minY - 1.0f)/TILE);
+        tx1 = std::min(tilesX - 1, (int)std::floor(t.maxX + 1.0f)/TILE);
+        ty1 = std::min(tilesY - 1, (int)std::floor(t.maxY + 1.0f)/TILE);
+    };
+
+    // Dirty tiles: everything under dynamic triangles, now and last frame
+    std::vector<uint8_t>& dyn = curDynamic;
+    dyn.assign((size_t)nTiles, 0);
+    for(const Tri& t : tris){
+        if(!t.dynamic) continue;
+        int tx0, ty0, tx1, ty1; tileRange(t, tx0, ty0, tx1, ty1);
+        for(int ty=ty0; ty<=ty1; ty++) for(int tx=tx0; tx<=tx1; tx++) dyn[ty*tilesX + tx] = 1;
+    }
+    const bool all = full || resized || background != lastBackground;
+    work.clear();
+    for(int i=0; i<nTiles; i++){
+        dirty[i] = all || dyn[i] || prevDynamic[i];
+        if(dirty[i]) work.push_back(i);
+    }
+    prevDynamic.swap(dyn);
+
+    // Bins: counted, then filled tile after tile into one array. A full
+    // frame bins every triangle everywhere, so twice that is room for the
+    // partial frames after it, however the hands move
+    auto forEachBin = [&](auto&& f){
+        for(uint32_t i=0; i<(uint32_t)tris.size(); i++){
+            int tx0, ty0, tx1, ty1; tileRange(tris[i], tx0, ty0, tx1, ty1);
+            for(int ty=ty0; ty<=ty1; ty++)
+                for(int tx=tx0; tx<=tx1; tx++)
+                    if(dirty[ty*tilesX + tx]) f(ty*tilesX + tx, i);
+        }
+    };
+    std::fill(binStart.begin(), binStart.end(), 0u);
+    forEachBin([&](int tile, uint32_t){ binStart[tile + 1]++; });
+    for(int i=0; i<nTiles; i++) binStart[i + 1] += binStart[i];
+    if(all) binned.reserve(2*(size_t)binStart[nTiles]);
+    binned.resize(binStart[nTiles]);
+    std::copy(binStart.begin(), binStart.end() - 1, binCursor.begin());
+    forEachBin([&](int tile, uint32_t i){ binned[binCursor[tile]++] = i; });
+
+    // Tiles are independent: workers and this thread pull them off one counter
+    nextTile = 0;
+    {
+        std::lock_guard<std::mutex> g(lock);
+        generation++;
+        busy = (int)workers.size();
+    }
+    wake.notify_all();
+    drain(callerSamples);
+    {
+        std::unique_lock<std::mutex> lk(lock);
+        idle.wait(lk, [&]{ return busy == 0; });
+    }
+    resized = false;
+    lastBackground = background;
+    return (int)work.size();
+}
+
+void SoftRasterizer::destroy(){
+    {
+        std::lock_guard<std::mutex> g(lock);
+        quit = true;
+    }
+    wake.notify_all();
+    for(std::thread& t : workers) t.join();
+    workers.clear();
+    quit = false;
+}
+
+// ================= Tiles =================
+// `seen`: the generation at spawn, so a late-starting worker still joins
+// (and counts down) the frame that was already counting on it.
+void SoftRasterizer::worker(unsigned seen){
+    std::vector<uint32_t> samples(SAMPLES*TILE*TILE);
+    for(;;){
+        {
+            std::unique_lock<std::mutex> lk(lock);
+            wake.wait(lk, [&]{ return quit || generation != seen; });
+            if(quit) return;
+            seen = generation;
+        }
+        drain(samples);
+        std::lock_guard<std::mutex> g(lock);
+        if(--busy == 0) idle.notify_one();
+    }
+}
+
+void SoftRasterizer::drain(std::vector<uint32_t>& samples){
+    for(int i; (i = nextTile.fetch_add(1)) < (int)work.size(); ) rasterTile(work[i], samples.data());
+}
+
+// Clears the tile's samples, draws its triangles in order, resolves.
+// Sample plane s, row y holds TILE consecutive pixels, so 4 lanes = 4 pixels.
+void SoftRasterizer::rasterTile(int tile, uint32_t* samples){
+    const int x0 = (tile % tilesX)*TILE, y0 = (tile / tilesX)*TILE;
+    std::fill(samples, samples + SAMPLES*TILE*TILE, background);
+    const F4 lanes = ramp(), one = splat(1.0f);
+
+    for(uint32_t k=binStart[tile]; k<binStart[tile + 1]; k++){
+        const Tri& t = tris[binned[k]];
+        int ix0 = std::max(x0, (int)std::floor(t.minX - 1.0f));
+        int iy0 = std::max(y0, (int)std::floor(t.minY - 1.0f));
+        int ix1 = std::min(x0 + TILE - 1, (int)std::floor(t.maxX + 1.0f));
+        int iy1 = std::min(y0 + TILE - 1, (int)std::floor(t.maxY + 1.0f));
+        if(ix0 > ix1 || iy0 > iy1) continue;
+        ix0 = x0 + ((ix0 - x0) & ~3);
+        const F4 A0 = splat(t.A[0]), A1 = splat(t.A[1]), A2 = splat(t.A[2]);
+        for(int s=0; s<SAMPLES; s++){
+            uint32_t* plane = samples + s*TILE*TILE;
+            for(int y=iy0; y<=iy1; y++){
+                const float py = (float)y + 0.5f + SAMPLE_Y[s];
+                const F4 r0 = splat(t.B[0]*py + t.C[0]);
+                const F4 r1 = splat(t.B[1]*py + t.C[1]);
+                const F4 r2 = splat(t.B[2]*py + t.C[2]);
+                uint32_t* row = plane + (y - y0)*TILE;
+                for(int x=ix0; x<=ix1; x+=4){
+                    const F4 px = madd(lanes, one, splat((float)x + 0.5f + SAMPLE_X[s]));
+                    const M4 m = inside(madd(A0, px, r0), madd(A1, px, r1), madd(A2, px, r2));
+                    if(none(m)) continue;
+                    if(!t.sdf){ store(row + (x - x0), m, t.color); continue; }
+                    const float sx = (float)x + 0.5f + SAMPLE_X[s];
+                    for(int l=0, b=bits(m); l<4; l++)
+                        if((b >> l & 1) && sdfInside(t, sx + (float)l, py)) row[x - x0 + l] = t.color;
+                }
+            }
+        }
+    }
+
+    // Resolve: box filter over the samples
+    const int yEnd = std::min(y0 + TILE, h), xEnd = std::min(x0 + TILE, w);
+    for(int y=y0; y<yEnd; y++){
+        uint32_t* dst = &pixels[(size_t)y*w];
+        for(int x=x0; x<xEnd; x++){
+            uint32_t rb = 0, ga = 0; // two 8-bit channels per 16-bit half of each sum
+            for(int s=0; s<SAMPLES; s++){
+                uint32_t c = samples[s*TILE*TILE + (y - y0)*TILE + (x - x0)];
+                rb += c & 0x00FF00FFu;
+                ga += (c >> 8) & 0x00FF00FFu;
+            }
+            rb = ((rb + 0x00020002u) >> 2) & 0x00FF00FFu;
+            ga = ((ga + 0x00020002u) >> 2) & 0x00FF00FFu;
+            dst[x] = rb | ga << 8;
+        }
+    }
+}
+
+// ================= Software backend =================
+void SoftBackend::init(int W, int H, const GlyphAtlas& a){
+    atlas = &a;
+    unsigned n = std::thread::hardware_concurrency();
+    sr.init(W, H, n > 1 ? n - 1 : 0); // the render thread rasterizes too
+}
+
+void SoftBackend::uploadGeometry(const float* v, int nv, const uint16_t* idx, int ni, int totalV, int totalI){
+    verts.assign(v, v + 2*nv);     verts.resize(2*(size_t)totalV);
+    indices.assign(idx, idx + ni); indices.resize((size_t)totalI);
+}
+
+bool SoftBackend::mapGeometry(int vertex, int, int index, int, float*& v, uint16_t*& idx){
+    v   = &verts[2*(size_t)vertex];
+    idx = &indices[(size_t)index];
+    return true;
+}
+
+void SoftBackend::beginFrame(int, int, const DamageRect&, const float bg[3]){
+    sr.begin(SoftRasterizer::pack(bg[0], bg[1], bg[2]));
+    full = false;
+}
+
+void SoftBackend::drawStatic(const RenderList& rl, const int* layers, int count, int clocks, bool dirty){
+    for(int i=0; i<count; i++) draw(rl, layers[i], clocks, 0, 0, false);
+    full = full || dirty;
+}
+
+// Everything else redraws its tiles every frame: a static triangle that
+// moves would leave its old pixels behind
+void SoftBackend::drawLayer(const RenderList& rl, int layer, int clocks, int recordStride, int clockBase){
+    draw(rl, layer, clocks, recordStride, clockBase, true);
+}
+
+void SoftBackend::endFrame(){ tiles += sr.end(full); }
+
+void SoftBackend::readback(FrameSink& sink, int frame){
+    sink.submit(frame, (const unsigned char*)sr.pixels.data());
+}
+
+void SoftBackend::report(long frames) const {
+    if(frames > 0)
+        std::fprintf(stderr, "[Soft] %.1f of %d tiles redrawn per frame\n", (double)tiles/frames, sr.tilesX*sr.tilesY);
+}
+
+void SoftBackend::draw(const RenderList& rl, int layer, int clocks, int recordStride, int clockBase, bool dynamic){
+    const RenderList::Layer& L = rl.layers[layer];
+    if(!L.recordCount) return;
+    const float hw = 0.5f*sr.w, hh = 0.5f*sr.h;
+    for(int k=0; k<clocks; k++){
+        const float* g = &rl.clockXf[4*(clockBase + k)];
+        for(int id=L.firstRecord; id<L.firstRecord+L.recordCount; id++){
+            const Mesh& m = rl.meshes[id];
+            const DrawRecord& d = rl.records[id + k*recordStride];
+            const uint32_t color = SoftRasterizer::pack(d.r, d.g, d.b);
+            const int cell = (int)d.glyph - 1;
+            const float cu = (float)(cell % GlyphAtlas::COLS), cv = (float)(cell / GlyphAtlas::COLS);
+            for(int i=0; i+2<m.count; i+=3){
+                float xy[6], uv[6];
+                for(int v=0; v<3; v++){
+                    const float* a = &verts[2*(m.baseVertex + indices[m.firstIndex + i + v])];
+                    const float px = d.m[0]*a[0] + d.m[2]*a[1] + d.tx;
+                    const float py = d.m[1]*a[0] + d.m[3]*a[1] + d.ty;
+                    xy[2*v]   = (px*g[0] + g[2] + 1.0f)*hw;
+                    xy[2*v+1] = (py*g[1] + g[3] + 1.0f)*hh;
+                    uv[2*v]   = (cu + a[0] + 0.5f)/GlyphAtlas::COLS;
+                    uv[2*v+1] = (cv + a[1] + 0.5f)/atlas->rows;
+                }
+                if(cell < 0) sr.add(xy, color, dynamic);
+                else sr.addSdf(xy, uv, color, dynamic, atlas->texels.data(), atlas->width, atlas->height);
+            }
+            g_draws.verts += m.count;
+        }
+    }
+    g_draws.draws++;
+}
@@ -0,0 +1,115 @@
+// src/soft_raster.h
+// Software rasterizer: the renderer used when no GL context can be made.
+// Triangles (pixel space, y up, opaque, one color each) are binned into
+// TILE x TILE tiles; a worker pool rasterizes tiles in parallel, testing
+// 4 pixels at a time against the half-space edge functions with SIMD
+// (SSE2 / NEON / scalar), into a tile-local 4x rotated-grid multisample
+// buffer that is then resolved into the framebuffer.
+// Glyph triangles carry texture coordinates into a distance-field atlas
+// and keep only the samples inside the glyph (the multisampling is the AA).
+// Triangles added as dynamic define the dirty region: a frame redraws only
+// the tiles they touch now or touched last frame, the rest keep their pixels.
+// SoftBackend puts it behind the RenderBackend seam.
+#pragma once
+
+#include "glyph_atlas.h"
+#include "render_backend.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SoftRasterizer {
+    static const int TILE = 32;
+    static const int SAMPLES = 4;
+
+    int w=0, h=0, tilesX=0, tilesY=0;
+    std::vector<uint32_t> pixels; // RGBA8 (R in the low byte), bottom row first like glReadPixels
+
+    // (Re)allocates for W x H with `threads` workers besides the caller's.
+    void init(int W, int H, unsigned threads);
+    // Starts a frame's triangle list (draw order = list order).
+    void begin(uint32_t background);
+    // xy: three pixel-space vertices.
+    void add(const float xy[6], uint32_t color, bool dynamic);
+    // uv: the vertices' texture coordinates (0..1) into `sdf`, an R8
+    // distance field of texW x texH, bottom row first, inside >= 0.5.
+    void addSdf(const float xy[6], const float uv[6], uint32_t color, bool dynamic,
+                const uint8_t* sdf, int texW, int texH);
+    // Rasterizes the frame; full redraws every tile (static content
+    // changed). Returns the number of tiles redrawn.
+    int  end(bool full);
+    void destroy();
+
+    static uint32_t pack(float r, float g, float b);
+
+    // ---- internals ----
+    struct Tri {
+        float A[3], B[3], C[3];       // edge i: A*x + B*y + C >= 0 inside
+        float minX, minY, maxX, maxY; // pixel bounds
+        uint32_t color;
+        bool dynamic;
+        const uint8_t* sdf;           // null: solid
+        int   texW, texH;
+        float U[3], V[3];             // texel coordinates: U[0]*x + U[1]*y + U[2]
+    };
+    std::vector<Tri> tris;
+    std::vector<uint32_t> binned;            // triangle indices, tile after tile
+    std::vector<uint32_t> binStart;          // per tile: first in `binned` ([tiles] = end)
+    std::vector<uint32_t> binCursor;         // fill position per tile
+    std::vector<uint8_t> curDynamic, prevDynamic, dirty; // per tile
+    std::vector<int> work;                   // tiles to redraw this frame
+    uint32_t background=0, lastBackground=0;
+    bool     resized=true;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake, idle;
+    unsigned generation=0;
+    int      busy=0;
+    bool     quit=false;
+    std::atomic<int> nextTile{0};
+    std::vector<uint32_t> callerSamples;     // the calling thread's tile buffer
+
+    bool setup(const float xy[6], Tri& t) const;
+    void worker(unsigned seen);
+    void drain(std::vector<uint32_t>& samples);
+    void rasterTile(int tile, uint32_t* samples);
+};
+
+// ================= Software backend =================
+// The CPU twin of GlBackend (main.cpp): same records, meshes and dial
+// placement, transformed here as VS_SRC does and handed to the rasterizer
+// (glyph quads with their atlas coordinates). Used when there is no GL
+// context (--software, or the window could not be made), offline only, so
+// frames are read back and never presented.
+struct SoftBackend : RenderBackend {
+    SoftRasterizer sr;
+    const GlyphAtlas* atlas=nullptr;
+    std::vector<float>    verts;    // GeometryArena storage: xy pairs
+    std::vector<uint16_t> indices;
+    bool full=false;                // static layers changed this frame
+    long tiles=0;                   // redrawn, over all frames
+
+    void init(int W, int H, const GlyphAtlas& a);
+
+    void uploadGeometry(const float* v, int nv, const uint16_t* idx, int ni, int totalV, int totalI) override;
+    bool mapGeometry(int vertex, int nv, int index, int ni, float*& v, uint16_t*& idx) override;
+    bool unmapGeometry() override { return true; }
+
+    void beginFrame(int W, int H, const DamageRect& damage, const float bg[3]) override;
+    // Static layers only repaint their dirty tiles
+    void drawStatic(const RenderList& rl, const int* layers, int count, int clocks, bool dirty) override;
+    void drawLayer(const RenderList& rl, int layer, int clocks, int recordStride, int clockBase) override;
+    void endFrame() override;
+    void present(GLFWwindow*, const DamageRect&, int, int) override {}
+    void readback(FrameSink& sink, int frame) override;
+    void report(long frames) const override;
+    void destroy() override { sr.destroy(); }
+
+    // dynamic: the triangles define this frame's dirty tiles
+    void draw(const RenderList& rl, int layer, int clocks, int recordStride, int clockBase, bool dynamic);
+};
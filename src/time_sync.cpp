@@ -0,0 +1,455 @@
+// src/time_sync.cpp
+#include "time_sync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+typedef SOCKET Socket;
+static const Socket NO_SOCKET = INVALID_SOCKET;
+static void closeSocket(Socket s){ closesocket(s); }
+static bool netInit(){ WSADATA d; return WSAStartup(MAKEWORD(2,2), &d) == 0; }
+static const char* netError(){
+    static char buf[32];
+    std::snprintf(buf, sizeof(buf), "winsock error %d", WSAGetLastError());
+    return buf;
+}
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+typedef int Socket;
+static const Socket NO_SOCKET = -1;
+static void closeSocket(Socket s){ close(s); }
+static bool netInit(){ return true; }
+static const char* netError(){ return std::strerror(errno); }
+#endif
+
+static_assert(std::atomic<int64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the shared page needs address-free atomics");
+
+static const int64_t NS = 1000000000;
+
+// steady_clock is CLOCK_MONOTONIC / QueryPerformanceCounter / mach_absolute_time:
+// one timeline for every process on the machine, so a steady reading means
+// the same instant in the writer and in every reader.
+int64_t steadyNowNs(){
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t systemUtcNs(){
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+int64_t TimeMapping::utcNs(int64_t steadyNs) const {
+    const int64_t d = steadyNs - steadyBase;   // split so days of elapsed time cannot overflow
+    return utcBase + d + (d/NS)*ratePpb + (d%NS)*ratePpb/NS;
+}
+
+// ================= Shared page =================
+static const uint32_t PAGE_MAGIC   = 0x53543243u; // "C2TS"
+static const uint32_t PAGE_VERSION = 1;
+#ifdef _WIN32
+static const char* PAGE_NAME   = "Local\\clock2d-time";
+static const char* WRITER_NAME = "Local\\clock2d-time-writer";
+#else
+static const char* PAGE_NAME   = "/clock2d-time";
+#endif
+
+bool SharedClock::attach(){
+    if(page) return true;
+#ifdef _WIN32
+    HANDLE h = OpenFileMappingA(FILE_MAP_READ, FALSE, PAGE_NAME);
+    if(!h) return false;
+    void* p = MapViewOfFile(h, FILE_MAP_READ, 0, 0, sizeof(TimePage));
+    if(!p){ CloseHandle(h); return false; }
+    mapping = h;
+#else
+    const int fd = shm_open(PAGE_NAME, O_RDONLY, 0);
+    if(fd < 0) return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(TimePage))
+        p = mmap(nullptr, sizeof(TimePage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED) return false;
+#endif
+    page = (TimePage*)p;
+    if(page->magic.load(std::memory_order_acquire) != PAGE_MAGIC
+    || page->version.load(std::memory_order_relaxed) != PAGE_VERSION){ detach(); return false; }
+    return true;
+}
+
+bool SharedClock::create(){
+    if(page) detach();
+#ifdef _WIN32
+    HANDLE lock = CreateMutexA(nullptr, TRUE, WRITER_NAME);
+    if(!lock) return false;
+    if(GetLastError() == ERROR_ALREADY_EXISTS){ CloseHandle(lock); return false; }
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(TimePage), PAGE_NAME);
+    void* p = h ? MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TimePage)) : nullptr;
+    if(!p){
+        std::fprintf(stderr, "[TimeSync] cannot create the shared page (error %lu)\n", GetLastError());
+        if(h) CloseHandle(h);
+        CloseHandle(lock);
+        return false;
+    }
+    mapping = h; writerLock = lock;
+#else
+    const int fd = shm_open(PAGE_NAME, O_RDWR | O_CREAT, 0644);
+    if(fd < 0){ std::fprintf(stderr, "[TimeSync] cannot create the shared page: %s\n", std::strerror(errno)); return false; }
+    // The lock lives as long as the descriptor, so a crashed writer frees it.
+    // Any failure (held elsewhere, ENOLCK, ...) means we are not the writer.
+    if(flock(fd, LOCK_EX | LOCK_NB) != 0){ close(fd); return false; }
+    struct stat st;
+    void* p = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (st.st_size >= (off_t)sizeof(TimePage) || ftruncate(fd, sizeof(TimePage)) == 0))
+        p = mmap(nullptr, sizeof(TimePage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED){
+        std::fprintf(stderr, "[TimeSync] cannot map the shared page: %s\n", std::strerror(errno));
+        close(fd);
+        return false;
+    }
+    lockFd = fd;
+#endif
+    page = (TimePage*)p;
+    writer = true;
+    withdraw(); // whatever a previous writer left is stale
+    page->version.store(PAGE_VERSION, std::memory_order_relaxed);
+    page->magic.store(PAGE_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void SharedClock::detach(){
+    if(page){
+        if(writer) withdraw();
+#ifdef _WIN32
+        UnmapViewOfFile(page);
+#else
+        munmap(page, sizeof(TimePage));
+#endif
+        page = nullptr;
+    }
+#ifdef _WIN32
+    if(mapping){ CloseHandle(mapping); mapping = nullptr; }
+    if(writerLock){ ReleaseMutex(writerLock); CloseHandle(writerLock); writerLock = nullptr; }
+#else
+    if(lockFd >= 0){ close(lockFd); lockFd = -1; }
+#endif
+    writer = false;
+}
+
+// Seqlock writer: seq goes odd, the fields change, seq goes even again.
+// The release fence keeps the field stores from moving above the first
+// increment; the final release store keeps them above the second. seq is
+// rounded down to even first: a writer that died mid-update left it odd,
+// and counting on from there would flip the parity for good.
+void SharedClock::publish(const TimeMapping& m, int stratum, int64_t errorNs, int64_t syncedAt){
+    const uint32_t s = page->seq.load(std::memory_order_relaxed) & ~1u;
+    page->seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    page->steadyBase.store(m.steadyBase, std::memory_order_relaxed);
+    page->utcBase.store(m.utcBase, std::memory_order_relaxed);
+    page->ratePpb.store(m.ratePpb, std::memory_order_relaxed);
+    page->errorNs.store(errorNs, std::memory_order_relaxed);
+    page->syncedAt.store(syncedAt, std::memory_order_relaxed);
+    page->stratum.store((uint32_t)stratum, std::memory_order_relaxed);
+    page->seq.store(s + 2, std::memory_order_release);
+}
+
+void SharedClock::withdraw(){ publish(TimeMapping{}, 0, 0, 0); }
+
+bool SharedClock::read(int64_t steadyNs, int64_t& utcNs, int* stratum){
+    if(!page){
+        if(steadyNs < retryAt) return false;
+        retryAt = steadyNs + RETRY_NS;
+        if(!attach()) return false;
+    }
+    // Bounded: a writer that died mid-update leaves seq odd until the next
+    // writer's create()
+    for(int tries=0; tries<64; tries++){
+        const uint32_t s0 = page->seq.load(std::memory_order_acquire);
+        if(s0 & 1u){ std::this_thread::yield(); continue; }
+        TimeMapping m;
+        m.steadyBase = page->steadyBase.load(std::memory_order_relaxed);
+        m.utcBase    = page->utcBase.load(std::memory_order_relaxed);
+        m.ratePpb    = page->ratePpb.load(std::memory_order_relaxed);
+        const int64_t  at = page->syncedAt.load(std::memory_order_relaxed);
+        const uint32_t st = page->stratum.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(page->seq.load(std::memory_order_relaxed) != s0) continue;
+        if(st == 0 || steadyNs - at > STALE_NS) return false;
+        utcNs = m.utcNs(steadyNs);
+        if(stratum) *stratum = (int)st;
+        return true;
+    }
+    return false;
+}
+
+// ================= SNTP (RFC 4330) =================
+static const int     NTP_PACKET = 48;
+static const int64_t NTP_UNIX_DELTA = INT64_C(2208988800);  // 1900-01-01 to 1970-01-01, s
+
+static void put32(uint8_t* p, uint32_t v){ p[0]=(uint8_t)(v>>24); p[1]=(uint8_t)(v>>16); p[2]=(uint8_t)(v>>8); p[3]=(uint8_t)v; }
+static uint32_t get32(const uint8_t* p){ return (uint32_t)p[0]<<24 | (uint32_t)p[1]<<16 | (uint32_t)p[2]<<8 | p[3]; }
+
+static void putNtpTime(uint8_t* p, int64_t utcNs){
+    int64_t sec = utcNs/NS, ns = utcNs%NS;
+    if(ns < 0){ sec--; ns += NS; }
+    put32(p, (uint32_t)(sec + NTP_UNIX_DELTA));
+    put32(p+4, (uint32_t)(((uint64_t)ns << 32)/NS));
+}
+static int64_t getNtpTime(const uint8_t* p){
+    int64_t sec = get32(p);
+    if(sec < INT64_C(0x80000000)) sec += INT64_C(0x100000000); // era 1 (from 2036-02-07)
+    return (sec - NTP_UNIX_DELTA)*NS + (int64_t)(((uint64_t)get32(p+4)*NS) >> 32);
+}
+
+static bool waitReadable(Socket s, double seconds){
+    fd_set rd;
+    FD_ZERO(&rd);
+    FD_SET(s, &rd);
+    timeval tv;
+    tv.tv_sec  = (long)seconds;
+    tv.tv_usec = (long)((seconds - (double)tv.tv_sec)*1e6);
+    return select((int)s + 1, &rd, nullptr, nullptr, &tv) > 0;
+}
+
+// HOST[:PORT], [V6ADDR][:PORT] or a bare IPv6 address
+static bool splitHostPort(const char* s, std::string& host, std::string& port, const char* defPort){
+    const char* colon = nullptr;
+    if(*s == '['){
+        const char* end = std::strchr(s, ']');
+        if(!end || (end[1] && end[1] != ':')) return false;
+        host.assign(s+1, end);
+        colon = end[1] ? end+1 : nullptr;
+    } else {
+        colon = std::strchr(s, ':');
+        if(colon && std::strchr(colon+1, ':')) colon = nullptr; // IPv6 without brackets
+        host = colon ? std::string(s, colon) : std::string(s);
+    }
+    port = colon ? colon+1 : (defPort ? defPort : "");
+    return !port.empty() && port.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// ================= Discipline =================
+bool TimeDiscipline::start(const char* server){
+    if(thread.joinable()) return true;
+    if(!splitHostPort(server, host, port, "123") || host.empty()){
+        std::fprintf(stderr, "[TimeSync] bad server '%s': expected HOST[:PORT]\n", server);
+        return false;
+    }
+    if(!netInit()){ std::fprintf(stderr, "[TimeSync] networking unavailable\n"); return true; }
+    if(!page.create()){
+        std::fprintf(stderr, "[TimeSync] another process disciplines the shared clock; following it\n");
+        return true;
+    }
+    quit = false;
+    thread = std::thread([this]{ run(); });
+    return true;
+}
+
+void TimeDiscipline::stop(){
+    if(thread.joinable()){
+        { std::lock_guard<std::mutex> g(lock); quit = true; }
+        cv.notify_one();
+        thread.join();
+    }
+    page.detach();
+}
+
+bool TimeDiscipline::query(int64_t& steadyMid, int64_t& utcMid, int64_t& delay, int& stratum){
+    const Socket s = (Socket)sock;
+    uint8_t req[NTP_PACKET] = {};
+    req[0] = (0 << 6) | (4 << 3) | 3;             // no leap warning, version 4, client
+    const int64_t t1 = steadyNowNs();
+    put32(req+40, (uint32_t)(t1 >> 32));          // transmit field as a nonce: the
+    put32(req+44, (uint32_t)t1);                  // server echoes it as the originate
+    if(send(s, (const char*)req, NTP_PACKET, 0) != NTP_PACKET) return false;
+    const int64_t deadline = t1 + (int64_t)(RESPONSE_TIMEOUT*1e9);
+    for(;;){
+        const int64_t left = deadline - steadyNowNs();
+        if(left <= 0 || !waitReadable(s, (double)left*1e-9)) return false;
+        uint8_t r[NTP_PACKET + 20];
+        const int n = (int)recv(s, (char*)r, sizeof(r), 0);
+        const int64_t t4 = steadyNowNs();
+        if(n < NTP_PACKET || std::memcmp(r+24, req+40, 8)) continue; // late reply to an earlier request
+        const int li = r[0] >> 6, mode = r[0] & 7;
+        stratum = r[1];
+        if(mode != 4 || li == 3 || stratum == 0 || stratum >= 16) return false; // unsynchronized or kiss-o'-death
+        const int64_t t2 = getNtpTime(r+32), t3 = getNtpTime(r+40);
+        if(t3 < t2) return false;
+        // The server's clock at the midpoint of the exchange, taking the
+        // two legs of the round trip as equal
+        delay     = std::max<int64_t>((t4 - t1) - (t3 - t2), 0);
+        steadyMid = t1 + (t4 - t1)/2;
+        utcMid    = t2 + (t3 - t2)/2;
+        return true;
+    }
+}
+
+// Steps the mapping on the first sample or a large offset; otherwise keeps
+// it continuous and slews the offset out over the next poll interval, with
+// the frequency learned from what the previous slew left behind.
+void TimeDiscipline::update(int64_t steadyMid, int64_t utcMid, int64_t delay, int stratum){
+    const int64_t err = samples ? utcMid - map.utcNs(steadyMid) : 0;
+    const bool step = samples == 0 || err > STEP_NS || err < -STEP_NS;
+    if(step){
+        map = TimeMapping{ steadyMid, utcMid, freqPpb };
+        slewPpb = lastErr = 0;
+        if(samples) std::fprintf(stderr, "[TimeSync] %s: stepped %+.3f ms\n", host.c_str(), (double)err*1e-6);
+        else std::fprintf(stderr, "[TimeSync] %s: synchronized (stratum %d, offset %+.3f ms from the system clock)\n",
+                          host.c_str(), stratum, (double)(utcMid - systemUtcNs() + (steadyNowNs() - steadyMid))*1e-6);
+    } else {
+        const int64_t dt = steadyMid - lastSample;
+        if(dt > NS){
+            // Offset the frequency is responsible for: err minus what the slew did not yet remove
+            const int64_t drift = err - (lastErr - (dt/NS)*slewPpb);
+            freqPpb += (int64_t)((double)drift*1e9/(double)dt*0.25);
+            freqPpb = std::min(std::max(freqPpb, -MAX_RATE_PPB), MAX_RATE_PPB);
+        }
+        const int64_t now = steadyNowNs();
+        const int64_t rate = std::min(std::max(freqPpb + (int64_t)((double)err/pollInterval()), -MAX_RATE_PPB), MAX_RATE_PPB);
+        map = TimeMapping{ now, map.utcNs(now), rate };
+        slewPpb = rate - freqPpb;
+        lastErr = err;
+    }
+    lastSample = steadyMid;
+    samples++;
+    page.publish(map, stratum + 1, delay/2, steadyMid);
+    if(verbose)
+        std::fprintf(stderr, "[TimeSync] %s: offset %+.3f ms, delay %.3f ms, rate %+.2f ppm\n",
+                     host.c_str(), (double)err*1e-6, (double)delay*1e-6, (double)map.ratePpb*1e-3);
+}
+
+void TimeDiscipline::run(){
+    std::unique_lock<std::mutex> lk(lock);
+    while(!quit){
+        lk.unlock();
+        bool ok = false;
+        int64_t bestMid = 0, bestUtc = 0, bestDelay = INT64_MAX;
+        int bestStratum = 0;
+        addrinfo hints{};
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* res = nullptr;
+        if(getaddrinfo(host.c_str(), port.c_str(), &hints, &res) == 0 && res){
+            const Socket s = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+            // connected UDP: replies from anyone but the server are dropped
+            if(s != NO_SOCKET && connect(s, res->ai_addr, (int)res->ai_addrlen) == 0){
+                sock = (intptr_t)s;
+                for(int i=0; i<BURST; i++){
+                    int64_t mid, utc, delay; int stratum;
+                    if(query(mid, utc, delay, stratum) && delay < bestDelay){
+                        ok = true; bestMid = mid; bestUtc = utc; bestDelay = delay; bestStratum = stratum;
+                    }
+                    if(i+1 < BURST){
+                        lk.lock();
+                        cv.wait_for(lk, std::chrono::duration<double>(BURST_GAP), [&]{ return quit; });
+                        lk.unlock();
+                        if(quit) break;
+                    }
+                }
+                sock = -1;
+            }
+            if(s != NO_SOCKET) closeSocket(s);
+            freeaddrinfo(res);
+        }
+        if(ok){
+            if(unreachable) std::fprintf(stderr, "[TimeSync] %s: reachable again\n", host.c_str());
+            unreachable = false;
+            update(bestMid, bestUtc, bestDelay, bestStratum);
+        } else if(!unreachable && !quit){
+            std::fprintf(stderr, "[TimeSync] %s: no usable reply; keeping the last rate\n", host.c_str());
+            unreachable = true;
+        }
+        lk.lock();
+        cv.wait_for(lk, std::chrono::duration<double>(pollInterval()), [&]{ return quit; });
+    }
+}
+
+// ================= Server =================
+bool TimeServer::start(const char* addr){
+    if(thread.joinable()) return true;
+    std::string host, port;
+    if(std::strspn(addr, "0123456789") == std::strlen(addr)) port = addr;
+    else if(!splitHostPort(addr, host, port, nullptr)){
+        std::fprintf(stderr, "[TimeSync] bad listen address '%s': expected [ADDR:]PORT\n", addr);
+        return false;
+    }
+    if(!netInit()){ std::fprintf(stderr, "[TimeSync] networking unavailable\n"); return false; }
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = AI_PASSIVE;
+    addrinfo* res = nullptr;
+    if(getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0 || !res){
+        std::fprintf(stderr, "[TimeSync] cannot resolve %s\n", addr);
+        return false;
+    }
+    const Socket s = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    const bool bound = s != NO_SOCKET && bind(s, res->ai_addr, (int)res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if(!bound){
+        std::fprintf(stderr, "[TimeSync] cannot listen on %s: %s\n", addr, netError());
+        if(s != NO_SOCKET) closeSocket(s);
+        return false;
+    }
+    sock = (intptr_t)s;
+    quit = false;
+    thread = std::thread([this]{ run(); });
+    return true;
+}
+
+void TimeServer::stop(){
+    if(thread.joinable()){
+        quit = true;
+        thread.join();
+    }
+    if(sock != -1){ closeSocket((Socket)sock); sock = -1; }
+    clock.detach();
+}
+
+void TimeServer::run(){
+    const Socket s = (Socket)sock;
+    auto utcAt = [&](int64_t steadyNs, int& stratum)->int64_t {
+        int64_t utc;
+        if(clock.read(steadyNs, utc, &stratum)) return utc;
+        stratum = LOCAL_STRATUM;
+        return systemUtcNs();
+    };
+    while(!quit){
+        if(!waitReadable(s, 0.25)) continue;
+        uint8_t req[NTP_PACKET + 20];
+        sockaddr_storage from;
+        socklen_t fromLen = sizeof(from);
+        const int n = (int)recvfrom(s, (char*)req, sizeof(req), 0, (sockaddr*)&from, &fromLen);
+        int stratum;
+        const int64_t rx = utcAt(steadyNowNs(), stratum);
+        if(n < NTP_PACKET || (req[0] & 7) != 3) continue;  // clients only
+        uint8_t r[NTP_PACKET] = {};
+        r[0] = (uint8_t)((req[0] & 0x38) | 4);            // no leap warning, their version, server
+        r[1] = (uint8_t)stratum;
+        r[2] = req[2];                                    // poll
+        r[3] = (uint8_t)(int8_t)-20;                      // precision ~1 us
+        if(stratum == LOCAL_STRATUM) std::memcpy(r+12, "LOCL", 4);
+        putNtpTime(r+16, rx);                             // reference
+        std::memcpy(r+24, req+40, 8);                     // originate = their transmit
+        putNtpTime(r+32, rx);                             // receive
+        putNtpTime(r+40, utcAt(steadyNowNs(), stratum)); // transmit
+        sendto(s, (const char*)r, NTP_PACKET, 0, (const sockaddr*)&from, fromLen);
+    }
+}
@@ -0,0 +1,123 @@
+// src/time_sync.h
+// Shared, disciplined wall time for every clock process on a machine.
+// One process (--time-sync) polls an SNTP server and publishes a mapping
+// from the monotonic clock to UTC in a small shared-memory page; every
+// clock instance maps that page read-only and converts steady_clock::now()
+// (vDSO, no syscall) to UTC through it under a seqlock, so displays agree
+// with the server to within the network jitter and never take a lock.
+// Any process can also answer SNTP requests from its corrected time
+// (--time-serve), making one display the reference for the others.
+// PTP is left to the system (ptp4l/phc2sys discipline system_clock, which
+// is what readers fall back to when no page is published or it goes stale).
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// utc = utcBase + (steady - steadyBase) * (1 + ratePpb/1e9), in nanoseconds
+struct TimeMapping {
+    int64_t steadyBase=0, utcBase=0, ratePpb=0;
+    int64_t utcNs(int64_t steadyNs) const;
+};
+
+// The shared page. Fields are only meaningful between two equal, even
+// reads of `seq`; stratum 0 means nothing is published.
+struct TimePage {
+    std::atomic<uint32_t> magic, version;
+    std::atomic<uint32_t> seq;          // odd while the writer is mid-update
+    std::atomic<uint32_t> stratum;      // NTP stratum of this page's time
+    std::atomic<int64_t>  steadyBase, utcBase, ratePpb;
+    std::atomic<int64_t>  errorNs;      // half the best round trip of the last sample
+    std::atomic<int64_t>  syncedAt;     // steady ns of the last good sample
+};
+
+int64_t steadyNowNs();
+
+struct SharedClock {
+    static constexpr int64_t STALE_NS = INT64_C(600000000000);   // no sample for 10 min: ignore the page
+    static constexpr int64_t RETRY_NS = INT64_C(5000000000);     // reattach interval while unmapped
+
+    TimePage* page = nullptr;
+    bool      writer = false;
+    int64_t   retryAt = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+    void* writerLock = nullptr;
+#else
+    int   lockFd = -1;
+#endif
+
+    // Reader: maps an existing page read-only. False if there is none yet.
+    bool attach();
+    // Writer: creates the page and takes the single-writer lock. False if
+    // another process already disciplines it.
+    bool create();
+    void detach();
+    void publish(const TimeMapping& m, int stratum, int64_t errorNs, int64_t syncedAt);
+    void withdraw();  // readers fall back to their own clock
+    // UTC for a steady_clock reading; false without a fresh page. Without
+    // one, retries attach() every RETRY_NS.
+    bool read(int64_t steadyNs, int64_t& utcNs, int* stratum = nullptr);
+};
+
+// SNTP client: disciplines the shared page from one server.
+struct TimeDiscipline {
+    static const int BURST = 4;                  // requests per poll; the fastest round trip wins
+    static constexpr double BURST_GAP = 2.0;     // s between them (servers rate-limit)
+    static const int FAST_POLLS = 4;             // first polls at POLL_FAST while the rate settles
+    static constexpr double POLL_FAST = 8.0;     // s
+    static constexpr double POLL = 64.0;         // s
+    static constexpr double RESPONSE_TIMEOUT = 1.0; // s
+    static constexpr int64_t STEP_NS = INT64_C(128000000);   // larger offsets step instead of slewing
+    static constexpr int64_t MAX_RATE_PPB = 500000;           // 500 ppm, as ntpd
+
+    std::string host, port;
+    intptr_t sock = -1;
+    bool verbose = false;
+    SharedClock page;
+    TimeMapping map;
+    int64_t freqPpb = 0;      // oscillator estimate; map.ratePpb adds the phase slew on top
+    int64_t slewPpb = 0;      // map.ratePpb - freqPpb
+    int64_t lastErr = 0;      // offset still being slewed out, as of lastSample
+    int64_t lastSample = 0;   // steady ns
+    int     samples = 0;
+    bool    unreachable = false;
+
+    std::thread thread;
+    std::mutex  lock;
+    std::condition_variable cv;
+    bool quit = false;
+
+    // `server` is HOST[:PORT] or [V6ADDR]:PORT; false if malformed. If
+    // another process already disciplines the page this one just follows it.
+    bool start(const char* server);
+    void stop();
+    ~TimeDiscipline(){ stop(); }
+
+    // One request: steady midpoint, server UTC at that midpoint, round trip.
+    bool query(int64_t& steadyMid, int64_t& utcMid, int64_t& delay, int& stratum);
+    double pollInterval() const { return samples < FAST_POLLS ? POLL_FAST : POLL; }
+    void update(int64_t steadyMid, int64_t utcMid, int64_t delay, int stratum);
+    void run();
+};
+
+// SNTP responder: answers from the shared page, or from system_clock at
+// stratum LOCAL_STRATUM when nothing disciplines it.
+struct TimeServer {
+    static const int LOCAL_STRATUM = 10;
+
+    SharedClock clock;
+    std::thread thread;
+    std::atomic<bool> quit{false};
+    intptr_t sock = -1;
+
+    // `addr` is [ADDR:]PORT; false if the socket cannot be bound.
+    bool start(const char* addr);
+    void stop();
+    ~TimeServer(){ stop(); }
+    void run();
+};